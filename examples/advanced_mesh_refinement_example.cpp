@@ -2,7 +2,6 @@
 #include <vector>
 #include <memory>
 #include <stdexcept>
-#include <map>
 #include <fstream>
 #include <cmath>
 #include <array>
@@ -132,7 +131,7 @@ void demonstrateMeshQualityParameters() {
     std::cout << "• For multiphysics: Use 0.005mm or finer" << std::endl;
 }
 
-void exportConformalMesh(const SemiconductorDevice& device, const std::string& baseName);
+void exportConformalMesh(SemiconductorDevice& device, const std::string& baseName);
 
 void createConformalSimulationMesh(SemiconductorDevice& device, const std::string& outputName) {
     std::cout << "\\n\\n=== Creating Simulation-Quality Conformal Mesh ===" << std::endl;
@@ -223,7 +222,7 @@ void createConformalSimulationMesh(SemiconductorDevice& device, const std::strin
     exportConformalMesh(device, outputName);
 }
 
-void exportConformalMesh(const SemiconductorDevice& device, const std::string& baseName) {
+void exportConformalMesh(SemiconductorDevice& device, const std::string& baseName) {
     std::cout << "\\n=== Exporting Simulation-Ready Conformal Mesh ===" << std::endl;
     
     const BoundaryMesh* mesh = device.getGlobalMesh();
@@ -231,67 +230,22 @@ void exportConformalMesh(const SemiconductorDevice& device, const std::string& b
         throw std::runtime_error("No mesh available for export");
     }
     
-    const auto& nodes = mesh->getNodes();
-    const auto& elements = mesh->getElements();
-    
-    // Deduplicate for clean export
-    std::map<std::string, int> pointMap;
-    std::vector<gp_Pnt> uniquePoints;
-    std::vector<std::array<int, 3>> validElements;
-    
+    // Weld seam nodes for clean export
     double tolerance = 1e-12;  // Very tight tolerance for simulation
+    device.weldGlobalMesh(tolerance);
     
-    auto makePointKey = [tolerance](const gp_Pnt& p) -> std::string {
-        long long x = static_cast<long long>(p.X() / tolerance);
-        long long y = static_cast<long long>(p.Y() / tolerance);
-        long long z = static_cast<long long>(p.Z() / tolerance);
-        return std::to_string(x) + "_" + std::to_string(y) + "_" + std::to_string(z);
-    };
-    
-    // Deduplicate points
-    std::vector<int> nodeMapping(nodes.size());
-    for (size_t i = 0; i < nodes.size(); i++) {
-        std::string key = makePointKey(nodes[i]->point);
-        auto it = pointMap.find(key);
-        if (it == pointMap.end()) {
-            int newIndex = static_cast<int>(uniquePoints.size());
-            pointMap[key] = newIndex;
-            uniquePoints.push_back(nodes[i]->point);
-            nodeMapping[i] = newIndex;
-        } else {
-            nodeMapping[i] = it->second;
-        }
-    }
-    
-    // Remap elements
-    for (const auto& element : elements) {
-        if (element->nodeIds.size() == 3) {
-            std::array<int, 3> newNodeIds = {
-                nodeMapping[element->nodeIds[0]],
-                nodeMapping[element->nodeIds[1]], 
-                nodeMapping[element->nodeIds[2]]
-            };
-            
-            if (newNodeIds[0] != newNodeIds[1] && 
-                newNodeIds[1] != newNodeIds[2] && 
-                newNodeIds[2] != newNodeIds[0]) {
-                validElements.push_back(newNodeIds);
-            }
-        }
-    }
+    const MeshElementArrays& elements = mesh->getElementArrays();
     
     std::cout << "Conformal mesh export statistics:" << std::endl;
-    std::cout << "  • Unique nodes: " << uniquePoints.size() << std::endl;
-    std::cout << "  • Valid elements: " << validElements.size() << std::endl;
+    std::cout << "  • Unique nodes: " << mesh->getNodeCount() << std::endl;
+    std::cout << "  • Valid elements: " << elements.size() << std::endl;
     
     // Prepare material and region IDs based on Z-coordinate
     std::vector<int> materialIds;
     std::vector<int> regionIds;
     
-    for (const auto& element : validElements) {
-        double centroidZ = (uniquePoints[element[0]].Z() + 
-                           uniquePoints[element[1]].Z() + 
-                           uniquePoints[element[2]].Z()) / 3.0;
+    for (size_t e = 0; e < elements.size(); e++) {
+        double centroidZ = elements.centroidZ[e];
         
         int materialId, regionId;
         if (centroidZ < 0.1e-3) {
@@ -0,0 +1,251 @@
+#include "BoxBooleanEngine.h"
+#include "GeometryBuilder.h"
+
+#include <BRepAlgoAPI_Cut.hxx>
+#include <BRepAlgoAPI_Fuse.hxx>
+#include <TopTools_ListOfShape.hxx>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Interconnect-like stack: metal lines on alternating routing directions,
+// each level joined to the next by a via. Neighbouring solids overlap so
+// every boolean has real intersections to compute.
+std::vector<TopoDS_Shape> buildInterconnectStack(int levels, int linesPerLevel) {
+    const double pitch = 0.2e-6;
+    const double lineWidth = 0.1e-6;
+    const double lineLength = pitch * linesPerLevel;
+    const double metalThickness = 0.12e-6;
+    const double viaSize = 0.08e-6;
+    const double levelHeight = 0.2e-6;
+
+    std::vector<TopoDS_Shape> solids;
+    for (int level = 0; level < levels; level++) {
+        double z = level * levelHeight;
+        bool alongX = (level % 2 == 0);
+        for (int line = 0; line < linesPerLevel; line++) {
+            double offset = line * pitch;
+            if (alongX) {
+                solids.push_back(GeometryBuilder::createBox(
+                    gp_Pnt(0, offset, z), Dimensions3D(lineLength, lineWidth, metalThickness)));
+            } else {
+                solids.push_back(GeometryBuilder::createBox(
+                    gp_Pnt(offset, 0, z), Dimensions3D(lineWidth, lineLength, metalThickness)));
+            }
+        }
+        if (level + 1 < levels) {
+            // Via at the crossing of line k on this level and line k on the next
+            for (int line = 0; line < linesPerLevel; line++) {
+                double c = line * pitch + 0.5 * (lineWidth - viaSize);
+                solids.push_back(GeometryBuilder::createBox(
+                    gp_Pnt(c, c, z + metalThickness * 0.5),
+                    Dimensions3D(viaSize, viaSize, levelHeight)));
+            }
+        }
+    }
+    return solids;
+}
+
+// The shapes turned about the z axis. Faces are then off the coordinate
+// planes, so the box engine rejects them and every boolean on them runs in
+// the kernel.
+std::vector<TopoDS_Shape> tilted(const std::vector<TopoDS_Shape>& shapes) {
+    const gp_Ax1 axis(gp_Pnt(0, 0, 0), gp_Dir(0, 0, 1));
+    std::vector<TopoDS_Shape> result;
+    result.reserve(shapes.size());
+    for (const TopoDS_Shape& shape : shapes) {
+        result.push_back(GeometryBuilder::rotate(shape, axis, M_PI / 6));
+    }
+    return result;
+}
+
+// True when the box engine can't take the shapes, i.e. some operand isn't
+// made of axis-aligned boxes, so the GeometryBuilder booleans on them run in
+// the kernel
+bool bypassesBoxEngine(const std::vector<TopoDS_Shape>& shapes) {
+    std::vector<AxisBox> boxes;
+    for (const TopoDS_Shape& shape : shapes) {
+        if (!BoxBooleanEngine::decompose(shape, boxes)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The kernel path GeometryBuilder falls back to when the box engine can't
+// answer: one BRepAlgoAPI run with every other shape as a tool
+TopoDS_Shape kernelBoolean(BoxBooleanOp op, const std::vector<TopoDS_Shape>& shapes) {
+    TopTools_ListOfShape objects;
+    TopTools_ListOfShape tools;
+    objects.Append(shapes.front());
+    for (size_t i = 1; i < shapes.size(); i++) {
+        tools.Append(shapes[i]);
+    }
+
+    BRepAlgoAPI_Fuse fuseMaker;
+    BRepAlgoAPI_Cut cutMaker;
+    BRepAlgoAPI_BooleanOperation& maker = (op == BoxBooleanOp::Cut)
+        ? static_cast<BRepAlgoAPI_BooleanOperation&>(cutMaker)
+        : static_cast<BRepAlgoAPI_BooleanOperation&>(fuseMaker);
+    maker.SetArguments(objects);
+    maker.SetTools(tools);
+    maker.SetFuzzyValue(5e-9);
+    maker.SetNonDestructive(true);
+    maker.SetRunParallel(true);
+    maker.Build();
+    if (!maker.IsDone()) {
+        throw std::runtime_error("Kernel boolean failed");
+    }
+    return maker.Shape();
+}
+
+double secondsSince(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        int levels = (argc > 1) ? std::atoi(argv[1]) : 4;
+        int linesPerLevel = (argc > 2) ? std::atoi(argv[2]) : 8;
+        if (levels < 1 || linesPerLevel < 1) {
+            std::cerr << "Usage: " << argv[0] << " [levels] [linesPerLevel]" << std::endl;
+            return 1;
+        }
+
+        std::cout << "=== Multi-Shape Boolean Benchmark ===" << std::endl;
+        std::vector<TopoDS_Shape> solids = buildInterconnectStack(levels, linesPerLevel);
+        std::cout << "Interconnect stack: " << levels << " levels x " << linesPerLevel
+                  << " lines, " << solids.size() << " solids" << std::endl;
+
+        // Union: pairwise chain against a single general-fuse run, on the
+        // tilted stack so neither goes through the box engine
+        std::vector<TopoDS_Shape> tiltedSolids = tilted(solids);
+        if (!bypassesBoxEngine(tiltedSolids)) {
+            std::cerr << "Tilted stack would be answered by the box engine" << std::endl;
+            return 1;
+        }
+        GeometryBuilder::resetBooleanStats();
+        auto start = std::chrono::steady_clock::now();
+        TopoDS_Shape chained = tiltedSolids.front();
+        for (size_t i = 1; i < tiltedSolids.size(); i++) {
+            chained = GeometryBuilder::unionShapes(chained, tiltedSolids[i]);
+        }
+        double chainedTime = secondsSince(start);
+        BooleanStats chainStats = GeometryBuilder::getBooleanStats();
+
+        start = std::chrono::steady_clock::now();
+        TopoDS_Shape fused = GeometryBuilder::unionMultipleShapes(tiltedSolids);
+        double fusedTime = secondsSince(start);
+
+        double chainedVolume = GeometryBuilder::calculateVolume(chained);
+        double fusedVolume = GeometryBuilder::calculateVolume(fused);
+        double relDiff = std::abs(chainedVolume - fusedVolume) / std::max(chainedVolume, 1e-30);
+
+        std::cout << "\nUnion of " << tiltedSolids.size() << " tilted solids:" << std::endl;
+        std::cout << "  Pairwise unionShapes chain: " << chainedTime << " s" << std::endl;
+        std::cout << "    (" << chainStats.unionSkipped << " of " << chainStats.unionCalls
+                  << " unions skipped by the bounding-box check, "
+                  << chainStats.unionAnalytic << " computed as box booleans)" << std::endl;
+        std::cout << "  unionMultipleShapes:        " << fusedTime << " s" << std::endl;
+        std::cout << "  Speedup: " << (fusedTime > 0 ? chainedTime / fusedTime : 0.0) << "x" << std::endl;
+        std::cout << "  Volume (chain / one-shot): " << chainedVolume * 1e18 << " / "
+                  << fusedVolume * 1e18 << " um^3 (rel. diff " << relDiff << ")" << std::endl;
+
+        // Intersection: three offset boxes whose common part is 0.75 x 0.75 x 0.5 um,
+        // tilted like the stack
+        std::vector<TopoDS_Shape> boxes;
+        boxes.push_back(GeometryBuilder::createBox(gp_Pnt(0, 0, 0), Dimensions3D(1e-6, 1e-6, 1e-6)));
+        boxes.push_back(GeometryBuilder::createBox(gp_Pnt(0.25e-6, 0, 0), Dimensions3D(1e-6, 1e-6, 1e-6)));
+        boxes.push_back(GeometryBuilder::createBox(gp_Pnt(0, 0.25e-6, 0.5e-6), Dimensions3D(1e-6, 1e-6, 1e-6)));
+        std::vector<TopoDS_Shape> overlapping = tilted(boxes);
+        if (!bypassesBoxEngine(overlapping)) {
+            std::cerr << "Tilted boxes would be answered by the box engine" << std::endl;
+            return 1;
+        }
+
+        start = std::chrono::steady_clock::now();
+        TopoDS_Shape chainedCommon = overlapping.front();
+        for (size_t i = 1; i < overlapping.size(); i++) {
+            chainedCommon = GeometryBuilder::intersectShapes(chainedCommon, overlapping[i]);
+        }
+        double chainedCommonTime = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        TopoDS_Shape common = GeometryBuilder::intersectMultipleShapes(overlapping);
+        double commonTime = secondsSince(start);
+
+        std::cout << "\nIntersection of " << overlapping.size() << " solids:" << std::endl;
+        std::cout << "  Pairwise intersectShapes chain: " << chainedCommonTime << " s, volume "
+                  << GeometryBuilder::calculateVolume(chainedCommon) * 1e18 << " um^3" << std::endl;
+        std::cout << "  intersectMultipleShapes:        " << commonTime << " s, volume "
+                  << GeometryBuilder::calculateVolume(common) * 1e18 << " um^3 (expected 0.28125)" << std::endl;
+
+        // Box engine against the kernel on the axis-aligned stack: the union,
+        // and an oxide slab cut by every line and via. Lines run out through
+        // the slab sides, so the cut leaves no cavity.
+        const double stackLength = 0.2e-6 * linesPerLevel;
+        std::vector<TopoDS_Shape> slabCut;
+        slabCut.push_back(GeometryBuilder::createBox(
+            gp_Pnt(0.05e-6, 0.05e-6, -0.1e-6),
+            Dimensions3D(stackLength - 0.1e-6, stackLength - 0.1e-6, 0.2e-6 * levels + 0.2e-6)));
+        slabCut.insert(slabCut.end(), solids.begin(), solids.end());
+
+        std::cout << "\nBox engine vs BRepAlgoAPI:" << std::endl;
+        double maxEngineDiff = 0.0;
+        const struct {
+            const char* name;
+            BoxBooleanOp op;
+            const std::vector<TopoDS_Shape>& shapes;
+        } cases[] = {
+            {"Union of the stack", BoxBooleanOp::Union, solids},
+            {"Slab cut by the stack", BoxBooleanOp::Cut, slabCut},
+        };
+        for (const auto& c : cases) {
+            BoxBooleanEngine::clearCache();
+            start = std::chrono::steady_clock::now();
+            TopoDS_Shape analytic;
+            bool answered = BoxBooleanEngine::perform(c.op, c.shapes, analytic);
+            double analyticTime = secondsSince(start);
+
+            start = std::chrono::steady_clock::now();
+            TopoDS_Shape kernel = kernelBoolean(c.op, c.shapes);
+            double kernelTime = secondsSince(start);
+
+            double kernelVolume = GeometryBuilder::calculateVolume(kernel);
+            std::cout << "  " << c.name << " (" << c.shapes.size() << " solids):" << std::endl;
+            std::cout << "    BRepAlgoAPI: " << kernelTime << " s, volume " << kernelVolume * 1e18 << " um^3" << std::endl;
+            if (!answered) {
+                std::cout << "    Box engine:  not applicable" << std::endl;
+                continue;
+            }
+            double analyticVolume = GeometryBuilder::calculateVolume(analytic);
+            double diff = std::abs(analyticVolume - kernelVolume) / std::max(kernelVolume, 1e-30);
+            maxEngineDiff = std::max(maxEngineDiff, diff);
+            std::cout << "    Box engine:  " << analyticTime << " s, volume " << analyticVolume * 1e18
+                      << " um^3 (rel. diff " << diff << ")" << std::endl;
+            std::cout << "    Speedup: " << (analyticTime > 0 ? kernelTime / analyticTime : 0.0) << "x" << std::endl;
+        }
+
+        if (relDiff > 1e-6) {
+            std::cerr << "Union volumes differ between the two methods" << std::endl;
+            return 1;
+        }
+        if (maxEngineDiff > 1e-6) {
+            std::cerr << "Box engine volumes differ from BRepAlgoAPI" << std::endl;
+            return 1;
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -2,7 +2,6 @@
 #include <vector>
 #include <memory>
 #include <stdexcept>
-#include <map>
 
 // OpenCASCADE includes
 #include <gp_Pnt.hxx>
@@ -113,7 +112,7 @@ void generateFineConformalMesh(SemiconductorDevice& device) {
     std::cout << "✓ Fine conformal mesh generation completed" << std::endl;
 }
 
-void exportFineMeshWithDeduplication(const SemiconductorDevice& device, const std::string& filename) {
+void exportFineMeshWithDeduplication(SemiconductorDevice& device, const std::string& filename) {
     std::cout << "\nExporting fine mesh with deduplication..." << std::endl;
     
     const BoundaryMesh* mesh = device.getGlobalMesh();
@@ -121,71 +120,25 @@ void exportFineMeshWithDeduplication(const SemiconductorDevice& device, const st
         throw std::runtime_error("No global mesh available for export");
     }
     
-    const auto& nodes = mesh->getNodes();
-    const auto& elements = mesh->getElements();
+    std::cout << "Original mesh: " << mesh->getNodeCount() << " nodes, " << mesh->getElementCount() << " elements" << std::endl;
     
-    std::cout << "Original mesh: " << nodes.size() << " nodes, " << elements.size() << " elements" << std::endl;
+    // Merge nodes duplicated along face seams (1 nanometer tolerance);
+    // degenerate triangles are dropped by the weld
+    double tolerance = 1e-9;
+    device.weldGlobalMesh(tolerance);
     
-    // Create a map to deduplicate points with tolerance
-    std::map<std::string, int> pointMap;
-    std::vector<gp_Pnt> uniquePoints;
-    std::vector<std::array<int, 3>> validElements;
+    const MeshElementArrays& elements = mesh->getElementArrays();
     
-    double tolerance = 1e-9;  // 1 nanometer tolerance
-    
-    // Helper function to create a key for a point
-    auto makePointKey = [tolerance](const gp_Pnt& p) -> std::string {
-        long long x = static_cast<long long>(p.X() / tolerance);
-        long long y = static_cast<long long>(p.Y() / tolerance);
-        long long z = static_cast<long long>(p.Z() / tolerance);
-        return std::to_string(x) + "_" + std::to_string(y) + "_" + std::to_string(z);
-    };
-    
-    // Deduplicate points
-    std::vector<int> nodeMapping(nodes.size());
-    for (size_t i = 0; i < nodes.size(); i++) {
-        std::string key = makePointKey(nodes[i]->point);
-        auto it = pointMap.find(key);
-        if (it == pointMap.end()) {
-            int newIndex = static_cast<int>(uniquePoints.size());
-            pointMap[key] = newIndex;
-            uniquePoints.push_back(nodes[i]->point);
-            nodeMapping[i] = newIndex;
-        } else {
-            nodeMapping[i] = it->second;
-        }
-    }
-    
-    // Remap elements to use deduplicated point indices
-    for (const auto& element : elements) {
-        if (element->nodeIds.size() == 3) {
-            std::array<int, 3> newNodeIds = {
-                nodeMapping[element->nodeIds[0]],
-                nodeMapping[element->nodeIds[1]], 
-                nodeMapping[element->nodeIds[2]]
-            };
-            
-            // Check for degenerate triangles (all three points the same)
-            if (newNodeIds[0] != newNodeIds[1] && 
-                newNodeIds[1] != newNodeIds[2] && 
-                newNodeIds[2] != newNodeIds[0]) {
-                validElements.push_back(newNodeIds);
-            }
-        }
-    }
-    
-    std::cout << "Deduplicated mesh: " << uniquePoints.size() << " unique nodes, " 
-              << validElements.size() << " valid elements" << std::endl;
+    std::cout << "Deduplicated mesh: " << mesh->getNodeCount() << " unique nodes, " 
+              << elements.size() << " valid elements" << std::endl;
     
     // Prepare material IDs based on Z-coordinate of element centroid
     std::vector<int> materialIds;
     std::vector<int> regionIds;
     
-    for (const auto& element : validElements) {
-        // Calculate centroid Z coordinate
-        double centroidZ = (uniquePoints[element[0]].Z() + 
-                           uniquePoints[element[1]].Z() + 
-                           uniquePoints[element[2]].Z()) / 3.0;
+    for (size_t e = 0; e < elements.size(); e++) {
+        // Centroid Z coordinate
+        double centroidZ = elements.centroidZ[e];
         
         int materialId, regionId;
         if (centroidZ < 0.5e-3) {
@@ -208,8 +161,8 @@ void exportFineMeshWithDeduplication(const SemiconductorDevice& device, const st
     }
     
     std::cout << "✓ Exported fine mesh to " << filename << std::endl;
-    std::cout << "  • " << uniquePoints.size() << " unique nodes (no duplicates)" << std::endl;
-    std::cout << "  • " << validElements.size() << " triangular elements" << std::endl;
+    std::cout << "  • " << mesh->getNodeCount() << " unique nodes (no duplicates)" << std::endl;
+    std::cout << "  • " << elements.size() << " triangular elements" << std::endl;
     std::cout << "  • Material ID data for visualization" << std::endl;
 }
 
@@ -2,7 +2,6 @@
 #include <vector>
 #include <memory>
 #include <stdexcept>
-#include <map>
 #include <fstream>
 
 // OpenCASCADE includes
@@ -101,7 +100,7 @@ void generateUltraFineMesh(SemiconductorDevice& device) {
     std::cout << "✓ Ultra-fine conformal mesh generation completed" << std::endl;
 }
 
-void exportUltraFineMesh(const SemiconductorDevice& device, const std::string& filename) {
+void exportUltraFineMesh(SemiconductorDevice& device, const std::string& filename) {
     std::cout << "\nExporting ultra-fine mesh..." << std::endl;
     
     const BoundaryMesh* mesh = device.getGlobalMesh();
@@ -109,76 +108,29 @@ void exportUltraFineMesh(const SemiconductorDevice& device, const std::string& f
         throw std::runtime_error("No global mesh available for export");
     }
     
-    const auto& nodes = mesh->getNodes();
-    const auto& elements = mesh->getElements();
-    
     std::cout << "Mesh statistics:" << std::endl;
-    std::cout << "  • Original nodes: " << nodes.size() << std::endl;
-    std::cout << "  • Original elements: " << elements.size() << std::endl;
-    
-    // Simple deduplication with tolerance
-    std::map<std::string, int> pointMap;
-    std::vector<gp_Pnt> uniquePoints;
-    std::vector<std::array<int, 3>> validElements;
-    
-    double tolerance = 1e-10;  // Very tight tolerance
+    std::cout << "  • Original nodes: " << mesh->getNodeCount() << std::endl;
+    std::cout << "  • Original elements: " << mesh->getElementCount() << std::endl;
     
-    // Create point keys for deduplication
-    auto makePointKey = [tolerance](const gp_Pnt& p) -> std::string {
-        long long x = static_cast<long long>(p.X() / tolerance);
-        long long y = static_cast<long long>(p.Y() / tolerance);
-        long long z = static_cast<long long>(p.Z() / tolerance);
-        return std::to_string(x) + "_" + std::to_string(y) + "_" + std::to_string(z);
-    };
+    // Weld duplicated seam nodes with a very tight tolerance
+    double tolerance = 1e-10;
+    device.weldGlobalMesh(tolerance);
     
-    // Deduplicate points
-    std::vector<int> nodeMapping(nodes.size());
-    for (size_t i = 0; i < nodes.size(); i++) {
-        std::string key = makePointKey(nodes[i]->point);
-        auto it = pointMap.find(key);
-        if (it == pointMap.end()) {
-            int newIndex = static_cast<int>(uniquePoints.size());
-            pointMap[key] = newIndex;
-            uniquePoints.push_back(nodes[i]->point);
-            nodeMapping[i] = newIndex;
-        } else {
-            nodeMapping[i] = it->second;
-        }
-    }
-    
-    // Remap elements and filter out degenerate ones
-    for (const auto& element : elements) {
-        if (element->nodeIds.size() == 3) {
-            std::array<int, 3> newNodeIds = {
-                nodeMapping[element->nodeIds[0]],
-                nodeMapping[element->nodeIds[1]], 
-                nodeMapping[element->nodeIds[2]]
-            };
-            
-            // Check for degenerate triangles
-            if (newNodeIds[0] != newNodeIds[1] && 
-                newNodeIds[1] != newNodeIds[2] && 
-                newNodeIds[2] != newNodeIds[0]) {
-                validElements.push_back(newNodeIds);
-            }
-        }
-    }
+    const MeshElementArrays& elements = mesh->getElementArrays();
     
-    std::cout << "  • Unique nodes: " << uniquePoints.size() << std::endl;
-    std::cout << "  • Valid elements: " << validElements.size() << std::endl;
+    std::cout << "  • Unique nodes: " << mesh->getNodeCount() << std::endl;
+    std::cout << "  • Valid elements: " << elements.size() << std::endl;
     
     // Calculate approximate VTK file size
-    size_t estimatedSize = uniquePoints.size() * 50 + validElements.size() * 30;
+    size_t estimatedSize = mesh->getNodeCount() * 50 + elements.size() * 30;
     std::cout << "  • Estimated VTK file size: " << estimatedSize / 1024 << " KB" << std::endl;
     
     // Prepare material and region IDs based on Z-coordinate of element centroid
     std::vector<int> materialIds;
     std::vector<int> regionIds;
     
-    for (const auto& element : validElements) {
-        double centroidZ = (uniquePoints[element[0]].Z() + 
-                           uniquePoints[element[1]].Z() + 
-                           uniquePoints[element[2]].Z()) / 3.0;
+    for (size_t e = 0; e < elements.size(); e++) {
+        double centroidZ = elements.centroidZ[e];
         
         int materialId, regionId;
         if (centroidZ < 0.2e-3) {
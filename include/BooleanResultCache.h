@@ -0,0 +1,85 @@
+// BooleanResultCache.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include <TopoDS_Shape.hxx>
+
+// Persistent, content-addressed store of boolean operation results shared
+// between processes. Keys combine a fingerprint of each operand (a 64-bit
+// hash of its mesh-free BinTools serialization, so shapes rebuilt the same
+// way in another run match) with the operation and fuzzy value. Operands
+// are not stored: if two different operands hash to the same fingerprint,
+// tryGet() silently returns the result computed for the other one.
+//
+// Results are stored as BinTools binary BRep, one file per key, in a local
+// directory. Files are written to a temporary name and renamed into place,
+// so concurrent processes never read partial entries. Once the directory
+// exceeds its byte cap, the least recently used entries are deleted down to
+// 90% of the cap. The size is tracked as a running total of this process's
+// stores, so the directory is only listed when that total crosses the cap.
+//
+// The cache is disabled until setDirectory() is given a non-empty path.
+class BooleanResultCache {
+public:
+    enum class Operation { Fuse, Common, Cut };
+
+    struct Key {
+        std::uint64_t first;
+        std::uint64_t second;
+        Operation operation;
+        double fuzzy;
+    };
+
+    struct Statistics {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t stores = 0;
+        size_t evictions = 0;
+    };
+
+    static BooleanResultCache& instance();
+
+    static std::uint64_t fingerprint(const TopoDS_Shape& shape);
+    static Key makeKey(Operation operation, const TopoDS_Shape& first,
+                       const TopoDS_Shape& second, double fuzzy);
+
+    // Creates the directory if needed; an empty path disables the cache
+    void setDirectory(const std::string& directory);
+    std::string getDirectory() const;
+    bool isEnabled() const;
+
+    void setMaxBytes(size_t max_bytes);
+    size_t getMaxBytes() const;
+
+    // Unreadable or mismatching entries count as misses and are removed
+    bool tryGet(const Key& key, TopoDS_Shape& result);
+    void put(const Key& key, const TopoDS_Shape& result);
+
+    // Deletes every entry in the directory
+    void clear();
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+    void printStatistics() const;
+
+private:
+    BooleanResultCache() = default;
+
+    std::string entryPath(const Key& key) const;
+    // Lists the directory, deletes the oldest entries once above the cap and
+    // resets the running total to what remains
+    void evictToBudget();
+
+    mutable std::mutex mtx_;
+    std::string directory_;
+    size_t max_bytes_ = size_t(1) << 30;
+    // Directory size as of the last scan plus later stores; not known until
+    // the first scan
+    std::uintmax_t known_bytes_ = 0;
+    bool size_known_ = false;
+    Statistics stats_;
+};
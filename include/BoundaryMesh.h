@@ -5,6 +5,9 @@
 #include <memory>
 #include <string>
 #include <array>
+#include <cstdint>
+#include <mutex>
+#include <set>
 
 // OpenCASCADE includes
 #include <TopoDS_Shape.hxx>
@@ -13,8 +16,17 @@
 #include <Poly_Triangulation.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
 
+#include "MeshBVH.h"
+#include "MeshQualityKernel.h"
+
+struct ImportedMesh;
+class OutputSink;
+
 /**
  * @brief Structure representing a mesh node
+ *
+ * Nodes are stored internally in MeshNodeArrays; MeshNode objects are only
+ * materialized for the compatibility view returned by BoundaryMesh::getNodes().
  */
 struct MeshNode {
     gp_Pnt point;
@@ -26,6 +38,9 @@ struct MeshNode {
 
 /**
  * @brief Structure representing a triangular mesh element
+ *
+ * Elements are stored internally in MeshElementArrays; MeshElement objects are
+ * only materialized for the compatibility view returned by BoundaryMesh::getElements().
  */
 struct MeshElement {
     std::array<int, 3> nodeIds;   // Indices of the three nodes
@@ -38,12 +53,121 @@ struct MeshElement {
         : nodeIds(nodes), id(elemId), faceId(face), area(0.0) {}
 };
 
+/**
+ * @brief Contiguous structure-of-arrays storage for mesh node coordinates
+ */
+struct MeshNodeArrays {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+    
+    size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+    void resize(size_t count) { x.resize(count); y.resize(count); z.resize(count); }
+    void reserve(size_t count) { x.reserve(count); y.reserve(count); z.reserve(count); }
+    void clear() { x.clear(); y.clear(); z.clear(); }
+    void push_back(const gp_Pnt& p) { x.push_back(p.X()); y.push_back(p.Y()); z.push_back(p.Z()); }
+    gp_Pnt point(size_t i) const { return gp_Pnt(x[i], y[i], z[i]); }
+};
+
+/**
+ * @brief Contiguous structure-of-arrays storage for triangular mesh elements
+ *
+ * Element i uses node indices triangles[3*i], triangles[3*i+1], triangles[3*i+2].
+ * All per-element arrays are parallel and indexed by the element index.
+ */
+struct MeshElementArrays {
+    std::vector<std::int32_t> triangles;  // Flat node index triples
+    std::vector<std::int32_t> faceIds;    // ID of the face each element belongs to
+    std::vector<double> areas;
+    std::vector<double> centroidX;
+    std::vector<double> centroidY;
+    std::vector<double> centroidZ;
+    
+    size_t size() const { return faceIds.size(); }
+    bool empty() const { return faceIds.empty(); }
+    void resize(size_t count) {
+        triangles.resize(3 * count);
+        faceIds.resize(count);
+        areas.resize(count);
+        centroidX.resize(count);
+        centroidY.resize(count);
+        centroidZ.resize(count);
+    }
+    void clear() { resize(0); }
+    const std::int32_t* nodes(size_t i) const { return &triangles[3 * i]; }
+    gp_Pnt centroid(size_t i) const { return gp_Pnt(centroidX[i], centroidY[i], centroidZ[i]); }
+};
+
+/**
+ * @brief Compressed-sparse-row adjacency
+ *
+ * The entries of row i are indices[offsets[i] .. offsets[i+1]), sorted ascending.
+ */
+struct MeshAdjacency {
+    std::vector<std::int32_t> offsets;
+    std::vector<std::int32_t> indices;
+    
+    size_t rowCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    bool empty() const { return offsets.empty(); }
+    void clear() { offsets.clear(); indices.clear(); }
+    std::int32_t degree(size_t row) const { return offsets[row + 1] - offsets[row]; }
+    const std::int32_t* begin(size_t row) const { return indices.data() + offsets[row]; }
+    const std::int32_t* end(size_t row) const { return indices.data() + offsets[row + 1]; }
+};
+
+/**
+ * @brief Read-only view of a run of indices owned by the mesh
+ *
+ * Valid until the mesh is regenerated, refined or welded.
+ */
+struct IndexSpan {
+    const std::int32_t* first = nullptr;
+    size_t count = 0;
+    
+    const std::int32_t* begin() const { return first; }
+    const std::int32_t* end() const { return first + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    std::int32_t operator[](size_t i) const { return first[i]; }
+};
+
+/**
+ * @brief Contiguous index range [first, first + count)
+ */
+struct IndexRange {
+    std::int32_t first = 0;
+    std::int32_t count = 0;
+    
+    std::int32_t end() const { return first + count; }
+    size_t size() const { return static_cast<size_t>(count); }
+    bool empty() const { return count == 0; }
+    bool contains(std::int32_t index) const { return index >= first && index < first + count; }
+};
+
+/**
+ * @brief Matched pair between two meshes found by interface detection
+ */
+struct InterfacePair {
+    std::int32_t index;       // Element or node in this mesh
+    std::int32_t otherIndex;  // Closest element or node in the other mesh
+    double distance;
+};
+
+/**
+ * @brief Result of BoundaryMesh::detectInterface, pairs sorted by index
+ */
+struct MeshInterface {
+    std::vector<InterfacePair> elementPairs;  // Element centroid lies on an element of the other mesh
+    std::vector<InterfacePair> nodePairs;     // Node coincides with a node of the other mesh
+};
+
 /**
  * @brief Structure representing a boundary face in the mesh
  */
 struct BoundaryFace {
     TopoDS_Face face;
-    std::vector<int> elementIds;  // Elements on this face
+    IndexRange elements;          // Elements on this face (faces own contiguous element runs)
     std::string name;
     int id;
     
@@ -51,15 +175,92 @@ struct BoundaryFace {
         : face(f), name(faceName), id(faceId) {}
 };
 
+/**
+ * @brief Parameters for feature-preserving Laplacian smoothing
+ *
+ * Nodes inside a single face move toward the average of their neighbours and
+ * are projected back onto the face surface. Nodes on face boundaries (seams
+ * and sharp feature edges) are locked, except that nodes on a locally straight
+ * seam may slide along it.
+ */
+struct SmoothingOptions {
+    int maxIterations = 5;
+    double relaxation = 0.5;               // Fraction of the move toward the neighbour average
+    bool projectToSurface = true;          // Project free nodes back onto their TopoDS_Face
+    bool slideAlongSeams = true;           // Let nodes on straight seams move along the seam
+    double seamCollinearity = 1e-3;        // Max sine of the seam bend that still counts as straight
+    double minImprovement = 1e-4;          // Stop once average quality improves by less than this
+};
+
+/**
+ * @brief Per-iteration outcome of BoundaryMesh::smoothMesh
+ */
+struct SmoothingReport {
+    std::vector<double> averageQuality;    // Entry 0 is before smoothing, then one per iteration kept
+    std::vector<double> minimumQuality;
+    int iterations = 0;
+    size_t freeNodes = 0;
+    size_t slidingNodes = 0;
+    size_t lockedNodes = 0;
+    bool stoppedEarly = false;             // Improvement fell below minImprovement or quality dropped
+};
+
+/**
+ * @brief Parameters for the in-surface Delaunay improvement pass
+ *
+ * Edges interior to a face are flipped until every pair of adjacent
+ * triangles satisfies the Delaunay angle criterion. Face boundaries are never
+ * changed, so seams stay conforming.
+ */
+struct DelaunayOptions {
+    double maxDihedralAngle = 0.1745;      // Only flip edges whose triangles bend less than this (rad)
+    bool insertSteinerPoints = false;      // Split the longest edge of poor triangles
+    double steinerQualityThreshold = 0.2;  // Triangles below this quality get split
+    int steinerPasses = 2;                 // Split/flip rounds when Steiner insertion is on
+};
+
+/**
+ * @brief Outcome of BoundaryMesh::delaunayRefinement
+ */
+struct DelaunayReport {
+    static constexpr int kHistogramBins = 10;  // Quality bins of width 0.1 over [0, 1]
+    std::vector<size_t> histogramBefore;
+    std::vector<size_t> histogramAfter;
+    size_t flips = 0;
+    size_t steinerPoints = 0;
+};
+
 /**
  * @brief Class for managing boundary meshes of semiconductor devices
  */
 class BoundaryMesh {
 private:
-    std::vector<std::unique_ptr<MeshNode>> m_nodes;
-    std::vector<std::unique_ptr<MeshElement>> m_elements;
+    MeshNodeArrays m_nodes;
+    MeshElementArrays m_elements;
     std::vector<std::unique_ptr<BoundaryFace>> m_faces;
     
+    // Connectivity (built by buildConnectivity)
+    MeshAdjacency m_nodeElements;   // node -> incident elements
+    MeshAdjacency m_nodeNeighbors;  // node -> distinct edge-connected nodes
+    MeshAdjacency m_faceNodes;      // face (index into m_faces) -> nodes, seam nodes included
+    std::vector<std::int32_t> m_faceIndexById;  // face id -> index into m_faces, -1 if absent
+    
+    // Compatibility view (pointer-based), materialized lazily from the arrays
+    mutable std::vector<std::unique_ptr<MeshNode>> m_nodeView;
+    mutable std::vector<std::unique_ptr<MeshElement>> m_elementView;
+    mutable bool m_viewValid;
+    mutable std::mutex m_viewMutex;
+    
+    // Search trees for point location, built lazily on first query
+    mutable std::unique_ptr<MeshBVH> m_elementTree;
+    mutable std::unique_ptr<MeshBVH> m_nodeTree;
+    mutable std::mutex m_treeMutex;
+    
+    // Per-element quality, computed lazily and dropped when node positions change
+    mutable TriangleQualityArrays m_quality;
+    mutable bool m_qualityValid;
+    mutable std::mutex m_qualityMutex;
+    
     TopoDS_Shape m_shape;
     double m_meshSize;
     double m_minMeshSize;
@@ -70,14 +271,45 @@ private:
     double m_maxAngle;
     double m_avgElementQuality;
     
+    // Tolerance for merging coincident nodes across face seams (0 = disabled)
+    double m_weldTolerance;
+    
+    // Reuse triangulations of identical geometry across generate() calls
+    bool m_useTriangulationCache;
+    
     // Internal mesh generation
     void generateTriangulation();
+    void assembleMesh();
     void extractMeshData();
+    bool loadCachedTriangulation(std::uint64_t shapeHash);
+    void storeCachedTriangulation(std::uint64_t shapeHash) const;
     void calculateElementProperties();
     void buildConnectivity();
+    void buildFaceRanges();
+    void clearMeshData();
+    size_t weldCoincidentNodes(double tolerance);
+    void adoptImportedMesh(ImportedMesh& mesh);
+    
+    // Compatibility view management
+    void ensureCompatibilityView() const;
+    void invalidateCompatibilityView();
+    
+    // Spatial index management
+    const MeshBVH& getElementTree() const;
+    const MeshBVH& getNodeTree() const;
+    void invalidateSpatialIndex();
+    void invalidateQualityCache();
+    double elementDistance2(size_t elementIndex, const double* p, double* closest) const;
+    
+    // Remesh the given faces (indices into m_faces) at localSize; see refine()
+    void refineFaces(const std::set<int>& targetFaces, double localSize);
+    
+    // Interface matching against another mesh's search trees
+    std::vector<InterfacePair> matchInterfaceElements(const BoundaryMesh& otherMesh, double tolerance) const;
+    std::vector<InterfacePair> matchInterfaceNodes(const BoundaryMesh& otherMesh, double tolerance) const;
     
     // Mesh quality assessment
-    double calculateTriangleAngle(const gp_Pnt& p1, const gp_Pnt& p2, const gp_Pnt& p3) const;
+    double calculateTriangleQuality(int n1, int n2, int n3, double area) const;
 
 public:
     explicit BoundaryMesh(const TopoDS_Shape& shape, double meshSize = 0.1);
@@ -86,18 +318,45 @@ public:
     // Mesh generation
     void generate();
     void regenerate(double newMeshSize);
+    // Local refinement: faces that own an element closest to one of the
+    // points are remeshed at localSize, then the faces sharing an edge with
+    // them are remeshed at the regular size so every seam stays conforming
+    // (no hanging nodes). Other faces keep their triangulation. Triangulations
+    // are replaced on the shape's faces in place, which other meshes built on
+    // the same shape also see.
     void refine(const std::vector<gp_Pnt>& refinementPoints, double localSize);
     
     // Adaptive mesh refinement
     void adaptiveMeshRefinement(double qualityThreshold = 0.3);
+    // Refines every face with a triangle within radius of one of the points
     void refineAroundPoints(const std::vector<gp_Pnt>& points, double radius, double localSize);
     void refineInterface(const BoundaryMesh& otherMesh, double interfaceSize);
     
-    // Mesh access
-    const std::vector<std::unique_ptr<MeshNode>>& getNodes() const { return m_nodes; }
-    const std::vector<std::unique_ptr<MeshElement>>& getElements() const { return m_elements; }
+    // Node welding: merge nodes duplicated along shared face edges into a
+    // watertight indexed mesh and drop triangles that collapse as a result.
+    // When a weld tolerance is set, generate() welds automatically.
+    void setWeldTolerance(double tolerance) { m_weldTolerance = tolerance; }
+    double getWeldTolerance() const { return m_weldTolerance; }
+    size_t weldNodes(double tolerance);
+    
+    // Triangulation caching (see TriangulationCache); enabled by default
+    void setUseTriangulationCache(bool use) { m_useTriangulationCache = use; }
+    bool getUseTriangulationCache() const { return m_useTriangulationCache; }
+    
+    // Mesh access (contiguous storage)
+    const MeshNodeArrays& getNodeArrays() const { return m_nodes; }
+    const MeshElementArrays& getElementArrays() const { return m_elements; }
+    gp_Pnt getNodePoint(size_t nodeIndex) const { return m_nodes.point(nodeIndex); }
+    
+    // Mesh access (compatibility view, built on first use)
+    const std::vector<std::unique_ptr<MeshNode>>& getNodes() const;
+    const std::vector<std::unique_ptr<MeshElement>>& getElements() const;
     const std::vector<std::unique_ptr<BoundaryFace>>& getFaces() const { return m_faces; }
     
+    // Connectivity (read-only CSR, shared by smoothing, interface detection and export)
+    const MeshAdjacency& getNodeElementAdjacency() const { return m_nodeElements; }
+    const MeshAdjacency& getNodeNodeAdjacency() const { return m_nodeNeighbors; }
+    
     size_t getNodeCount() const { return m_nodes.size(); }
     size_t getElementCount() const { return m_elements.size(); }
     size_t getFaceCount() const { return m_faces.size(); }
@@ -108,27 +367,57 @@ public:
     double getMaxMeshSize() const { return m_maxMeshSize; }
     double getAverageElementQuality() const { return m_avgElementQuality; }
     
-    // Geometric queries
+    // Geometric queries (BVH-accelerated; the trees are rebuilt after the mesh changes)
     MeshNode* findClosestNode(const gp_Pnt& point) const;
-    MeshElement* findElementContaining(const gp_Pnt& point) const;
+    MeshElement* findElementContaining(const gp_Pnt& point, double tolerance = 1e-6) const;
+    int findClosestNodeIndex(const gp_Pnt& point) const;
+    int findClosestElementIndex(const gp_Pnt& point, gp_Pnt* closestPoint = nullptr,
+                                double* distance = nullptr) const;
+    
+    // Batched queries, spread across threads. Results are indexed like the
+    // input points; -1 marks an empty mesh.
+    void findClosestNodes(const std::vector<gp_Pnt>& points, std::vector<int>& nodeIds) const;
+    void findClosestElements(const std::vector<gp_Pnt>& points, std::vector<int>& elementIds,
+                             std::vector<double>* distances = nullptr) const;
     std::vector<MeshElement*> getElementsOnFace(int faceId) const;
     std::vector<MeshNode*> getNodesOnFace(int faceId) const;
     
+    // Face queries without allocation: elements of a face are a contiguous
+    // range, nodes a sorted span (shared seam nodes appear on every face
+    // they touch). Unknown face ids yield empty results.
+    const BoundaryFace* getFace(int faceId) const;
+    IndexRange getFaceElementRange(int faceId) const;
+    IndexSpan getFaceNodeIndices(int faceId) const;
+    
     // Mesh quality analysis
     void analyzeMeshQuality();
     std::vector<MeshElement*> getLowQualityElements(double threshold = 0.3) const;
     double calculateMeshVolume() const;
     double calculateMeshSurfaceArea() const;
     double calculateElementQuality(const MeshElement& element) const;
+    double calculateElementQuality(size_t elementIndex) const;
+    const TriangleQualityArrays& getElementQualityArrays() const;
     
-    // Export functions (VTK export functionality moved to VTKExporter class)
-    void exportToSTL(const std::string& filename) const;
+    // Export functions (VTK export functionality moved to VTKExporter class).
+    // Output goes through a buffered OutputSink; coordinates are written in
+    // shortest round-trip form, so they read back exactly.
+    void exportToSTL(const std::string& filename, bool binary = false) const;
     void exportToGMSH(const std::string& filename) const;
     void exportToOBJ(const std::string& filename) const;
+    // Same formats into any OutputSink (memory buffer, span, descriptor);
+    // the sink is flushed but not closed
+    void exportToSTL(OutputSink& out, bool binary = false) const;
+    void exportToGMSH(OutputSink& out) const;
+    void exportToOBJ(OutputSink& out) const;
     
-    // Import functions
+    // Import functions (see MeshFileReader). The file replaces the current
+    // mesh data; on failure the mesh is left unchanged and false is returned.
+    // Face ids that match a face of this mesh's shape are re-attached to it,
+    // others get a face without geometry. STL stores every facet corner
+    // separately: a weldTolerance > 0 (or one set with setWeldTolerance)
+    // merges them into an indexed mesh.
     bool importFromVTK(const std::string& filename);
-    bool importFromSTL(const std::string& filename);
+    bool importFromSTL(const std::string& filename, double weldTolerance = 0.0);
     
     // Mesh statistics
     void printMeshStatistics() const;
@@ -141,10 +430,15 @@ public:
     
     // Smoothing operations
     void smoothMesh(int iterations = 5);
+    SmoothingReport smoothMesh(const SmoothingOptions& options);
     void laplacianSmoothing();
     void delaunayRefinement();
+    DelaunayReport delaunayRefinement(const DelaunayOptions& options);
     
-    // Interface detection
+    // Interface detection. The other mesh's trees are built once and this
+    // mesh is streamed through them in parallel with a search radius bounded
+    // by tolerance, so the cost is O((N + M) log M) rather than O(N * M).
+    MeshInterface detectInterface(const BoundaryMesh& otherMesh, double tolerance = 1e-6) const;
     std::vector<MeshElement*> findInterfaceElements(const BoundaryMesh& otherMesh, double tolerance = 1e-6) const;
     std::vector<MeshNode*> findInterfaceNodes(const BoundaryMesh& otherMesh, double tolerance = 1e-6) const;
 };
@@ -0,0 +1,44 @@
+// BoxBooleanEngine.h
+#pragma once
+
+#include <vector>
+
+#include <TopoDS_Shape.hxx>
+
+// Axis-aligned box [min[0], max[0]] x [min[1], max[1]] x [min[2], max[2]]
+struct AxisBox {
+    double min[3];
+    double max[3];
+};
+
+enum class BoxBooleanOp {
+    Union,   // Inside any operand
+    Common,  // Inside every operand
+    Cut      // Inside the first operand and none of the others
+};
+
+// Exact booleans for shapes made of axis-aligned boxes, the common case for
+// device stacks built with GeometryBuilder::createBox. Operands are
+// decomposed into boxes (box solids, or earlier results of this engine,
+// whose decomposition is cached), combined cell by cell on the grid spanned
+// by their coordinates, and only the final rectilinear solids are built as
+// BRep. Result vertices use the operands' coordinates as they are, so no
+// fuzzy value is involved.
+//
+// perform() returns false and leaves result untouched when it can't answer:
+// an operand is not made of axis-aligned boxes, or the result has a cavity,
+// an edge shared by four faces or too many grid cells. Callers then fall
+// back to BRepAlgoAPI.
+class BoxBooleanEngine {
+public:
+    // Empty results are an empty compound, one connected piece a solid and
+    // several pieces a compound of solids
+    static bool perform(BoxBooleanOp op, const std::vector<TopoDS_Shape>& operands,
+                        TopoDS_Shape& result);
+
+    // Boxes whose union is the shape; false if it isn't made of such boxes
+    static bool decompose(const TopoDS_Shape& shape, std::vector<AxisBox>& boxes);
+
+    // Drop cached decompositions of earlier results
+    static void clearCache();
+};
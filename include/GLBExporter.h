@@ -0,0 +1,65 @@
+#ifndef GLBEXPORTER_H
+#define GLBEXPORTER_H
+
+#include <string>
+
+// Forward declarations
+class OutputSink;
+class SemiconductorDevice;
+class BoundaryMesh;
+
+/**
+ * @brief Utility class for exporting boundary meshes as binary glTF 2.0 (.glb)
+ *
+ * The .glb layout is meant to be handed to WebGL viewers (three.js
+ * GLTFLoader, Babylon.js, model-viewer) as is. A single binary buffer holds
+ * all vertex positions as interleaved float32 xyz triples followed by all
+ * uint32 triangle indices. Each meshed DeviceLayer becomes one primitive of
+ * a single mesh, with its own material named after the layer and coloured by
+ * its MaterialType. The material extras carry the same MaterialID and
+ * RegionID values as the VTK export.
+ *
+ * The buffer is filled once, in parallel, straight from the mesh arrays and
+ * written as one block, so an in-memory export (OutputSink on a
+ * std::vector<char>) can be served without any re-encoding.
+ */
+class GLBExporter {
+public:
+    /**
+     * @brief Export a single boundary mesh as one primitive
+     *
+     * @param mesh The boundary mesh to export
+     * @param filename Output .glb filename
+     * @return true if export was successful, false otherwise
+     */
+    static bool exportMesh(const BoundaryMesh& mesh, const std::string& filename);
+
+    /**
+     * @brief Export a single boundary mesh to an output sink
+     *
+     * @param mesh The boundary mesh to export
+     * @param out Destination sink (flushed, not closed)
+     * @return true if export was successful, false otherwise
+     */
+    static bool exportMesh(const BoundaryMesh& mesh, OutputSink& out);
+
+    /**
+     * @brief Export all meshed device layers, one primitive and material each
+     *
+     * @param device The semiconductor device containing multiple layers
+     * @param filename Output .glb filename
+     * @return true if export was successful, false otherwise
+     */
+    static bool exportDevice(const SemiconductorDevice& device, const std::string& filename);
+
+    /**
+     * @brief Export all meshed device layers to an output sink
+     *
+     * @param device The semiconductor device containing multiple layers
+     * @param out Destination sink (flushed, not closed)
+     * @return true if export was successful, false otherwise
+     */
+    static bool exportDevice(const SemiconductorDevice& device, OutputSink& out);
+};
+
+#endif // GLBEXPORTER_H
@@ -42,6 +42,27 @@ struct Profile2D {
     void addPoint(double x, double y) { points.emplace_back(x, y, 0.0); }
 };
 
+/**
+ * @brief Counters of pairwise boolean operations, of those answered by the
+ *        bounding-box disjointness check (skipped) and of those computed by
+ *        BoxBooleanEngine (analytic), both without running the kernel
+ */
+struct BooleanStats {
+    size_t unionCalls = 0;
+    size_t unionSkipped = 0;
+    size_t unionAnalytic = 0;
+    size_t intersectCalls = 0;
+    size_t intersectSkipped = 0;
+    size_t intersectAnalytic = 0;
+    size_t subtractCalls = 0;
+    size_t subtractSkipped = 0;
+    size_t subtractAnalytic = 0;
+    
+    size_t totalCalls() const { return unionCalls + intersectCalls + subtractCalls; }
+    size_t totalSkipped() const { return unionSkipped + intersectSkipped + subtractSkipped; }
+    size_t totalAnalytic() const { return unionAnalytic + intersectAnalytic + subtractAnalytic; }
+};
+
 /**
  * @brief Utility class for building 3D geometries for semiconductor devices
  */
@@ -89,12 +110,28 @@ public:
     static TopoDS_Solid sweepProfile(const TopoDS_Wire& profile, const TopoDS_Wire& path);
     static TopoDS_Solid revolveProfile(const TopoDS_Wire& profile, const gp_Ax1& axis, double angle);
     
-    // Boolean operations
+    // Boolean operations. Operands whose cached bounding boxes (enlarged by
+    // the fuzzy value) do not overlap skip the kernel: a disjoint union is a
+    // compound of both, a disjoint intersection is an empty compound and a
+    // disjoint subtraction returns shape1 unchanged. Operands made of
+    // axis-aligned boxes are then combined exactly by BoxBooleanEngine. Other
+    // results are looked up in and stored to BooleanResultCache when enabled.
     static TopoDS_Shape unionShapes(const TopoDS_Shape& shape1, const TopoDS_Shape& shape2);
     static TopoDS_Shape intersectShapes(const TopoDS_Shape& shape1, const TopoDS_Shape& shape2);
     static TopoDS_Shape subtractShapes(const TopoDS_Shape& shape1, const TopoDS_Shape& shape2);
     
-    // Multi-shape boolean operations
+    // Process-wide counters for the operations above (thread-safe)
+    static BooleanStats getBooleanStats();
+    static void resetBooleanStats();
+    // Drop cached bounding boxes and box decompositions, e.g. after
+    // modifying shapes in place
+    static void clearBoundingBoxCache();
+    
+    // Multi-shape boolean operations: every argument is processed in a single
+    // parallel general-fuse run with the same fuzzy value and non-destructive
+    // mode as the pairwise operations, unless all arguments are made of
+    // axis-aligned boxes (see BoxBooleanEngine). The intersection expects
+    // solids and returns an empty compound when they have no common volume.
     static TopoDS_Shape unionMultipleShapes(const std::vector<TopoDS_Shape>& shapes);
     static TopoDS_Shape intersectMultipleShapes(const std::vector<TopoDS_Shape>& shapes);
     
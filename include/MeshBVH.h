@@ -0,0 +1,136 @@
+// MeshBVH.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Bounding-volume hierarchy over axis-aligned primitive boxes. BoundaryMesh
+// keeps one over its triangles and one over its nodes for closest-primitive
+// queries. The tree is built top-down by median split on the longest axis and
+// stored depth-first, so the left child of node i is always node i + 1.
+class MeshBVH {
+public:
+    MeshBVH() = default;
+
+    // boxes holds 6 doubles per primitive: minX, minY, minZ, maxX, maxY, maxZ
+    void build(const double* boxes, size_t primitiveCount);
+
+    bool empty() const { return m_nodes.empty(); }
+    size_t getPrimitiveCount() const { return m_primitives.size(); }
+    size_t getNodeCount() const { return m_nodes.size(); }
+
+    // Find the primitive nearest to (px, py, pz). distance2(primitive) returns
+    // the squared distance from the query point to that primitive. Subtrees
+    // whose box is farther than bestDistance2 are skipped, so passing a
+    // finite bound limits the search radius. Boxes at exactly the best
+    // distance are still searched, so ties go to the lowest index whatever
+    // the tree layout. Returns -1 if nothing is found strictly within the
+    // bound; on success bestDistance2 holds the winning distance.
+    template <typename PrimitiveDistance2>
+    std::int32_t nearest(double px, double py, double pz, PrimitiveDistance2&& distance2,
+                         double& bestDistance2) const {
+        std::int32_t best = -1;
+        if (m_nodes.empty()) return best;
+
+        std::int32_t stack[64];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0) {
+            const Node& node = m_nodes[stack[--stackSize]];
+            if (boxDistance2(node, px, py, pz) > bestDistance2) continue;
+
+            if (node.count > 0) {
+                for (std::int32_t k = node.start; k < node.start + node.count; k++) {
+                    const std::int32_t primitive = m_primitives[k];
+                    const double d2 = distance2(primitive);
+                    // Ties go to the lower index; see the pruning above
+                    if (d2 < bestDistance2 || (d2 == bestDistance2 && primitive < best)) {
+                        bestDistance2 = d2;
+                        best = primitive;
+                    }
+                }
+                continue;
+            }
+
+            // Push the farther child first so the nearer one is searched first
+            const std::int32_t left = static_cast<std::int32_t>(&node - m_nodes.data()) + 1;
+            const std::int32_t right = node.start;
+            const double leftDistance2 = boxDistance2(m_nodes[left], px, py, pz);
+            const double rightDistance2 = boxDistance2(m_nodes[right], px, py, pz);
+            if (leftDistance2 <= rightDistance2) {
+                stack[stackSize++] = right;
+                stack[stackSize++] = left;
+            } else {
+                stack[stackSize++] = left;
+                stack[stackSize++] = right;
+            }
+        }
+
+        return best;
+    }
+
+    // Call visit(primitive) for every primitive with distance2(primitive) <=
+    // radius2, in no particular order. Only subtrees whose box lies within
+    // the radius are searched.
+    template <typename PrimitiveDistance2, typename Visit>
+    void forEachWithin(double px, double py, double pz, double radius2,
+                       PrimitiveDistance2&& distance2, Visit&& visit) const {
+        if (m_nodes.empty()) return;
+
+        std::int32_t stack[64];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0) {
+            const Node& node = m_nodes[stack[--stackSize]];
+            if (boxDistance2(node, px, py, pz) > radius2) continue;
+
+            if (node.count > 0) {
+                for (std::int32_t k = node.start; k < node.start + node.count; k++) {
+                    const std::int32_t primitive = m_primitives[k];
+                    if (distance2(primitive) <= radius2) visit(primitive);
+                }
+                continue;
+            }
+
+            stack[stackSize++] = node.start;
+            stack[stackSize++] = static_cast<std::int32_t>(&node - m_nodes.data()) + 1;
+        }
+    }
+
+    // Closest point to p on triangle (a, b, c); all points are xyz triples.
+    // Returns the squared distance and writes the point to closest.
+    static double closestPointOnTriangle(const double* p, const double* a, const double* b,
+                                         const double* c, double* closest);
+
+private:
+    // Interior nodes: count == 0 and start is the right child index.
+    // Leaves: primitives m_primitives[start .. start + count).
+    struct Node {
+        double bmin[3];
+        double bmax[3];
+        std::int32_t start;
+        std::int32_t count;
+    };
+
+    static double boxDistance2(const Node& node, double px, double py, double pz) {
+        const double p[3] = {px, py, pz};
+        double d2 = 0.0;
+        for (int axis = 0; axis < 3; axis++) {
+            double d = 0.0;
+            if (p[axis] < node.bmin[axis]) d = node.bmin[axis] - p[axis];
+            else if (p[axis] > node.bmax[axis]) d = p[axis] - node.bmax[axis];
+            d2 += d * d;
+        }
+        return d2;
+    }
+
+    std::int32_t buildRecursive(const double* boxes, const std::vector<double>& centers,
+                                std::int32_t begin, std::int32_t end);
+
+    std::vector<Node> m_nodes;
+    std::vector<std::int32_t> m_primitives;
+};
@@ -0,0 +1,51 @@
+// MeshFileReader.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BoundaryMesh.h"
+
+// Read-only view of a whole file. On POSIX systems the file is memory
+// mapped; elsewhere it is read into a buffer. Throws std::runtime_error if
+// the file cannot be opened.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<char> buffer_;
+};
+
+// Triangle mesh read from a file, in BoundaryMesh storage layout
+struct ImportedMesh {
+    MeshNodeArrays nodes;
+    std::vector<std::int32_t> triangles;  // Flat node index triples
+    std::vector<std::int32_t> faceIds;    // 0 when the file carries no face information
+    size_t skippedCells = 0;              // Vertex, line and volume cells that were ignored
+};
+
+// Readers for legacy VTK (ASCII and BINARY, UNSTRUCTURED_GRID and POLYDATA,
+// file versions up to 5.1) and STL (ASCII and binary). Bulk sections are
+// parsed in parallel chunks straight from the mapped file with
+// std::from_chars. Quads, pixels, polygons and triangle strips are split
+// into triangles; face ids come from a "FaceID" cell array in VTK files and
+// from the solid index in multi-solid ASCII STL files. Malformed input
+// throws std::runtime_error.
+class MeshFileReader {
+public:
+    static ImportedMesh readVTK(const std::string& filename);
+    static ImportedMesh readSTL(const std::string& filename);
+};
@@ -0,0 +1,102 @@
+// OutputSink.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Buffered output shared by the mesh exporters. Text and binary data are
+// collected in a large buffer that is only handed to the target when it
+// fills up, so there are no per-line flushes. Numbers are formatted with
+// std::to_chars; floating-point values use the shortest representation that
+// reads back to the same value. I/O errors throw std::runtime_error.
+//
+// The target is a file, a growable memory buffer, a caller-provided span or
+// an already-open file descriptor, so the same writer code can produce a
+// file or an in-memory copy without a filesystem round trip.
+class OutputSink {
+public:
+    // Fixed-size caller memory; writing past its end throws
+    struct Span {
+        void* data;
+        size_t size;
+    };
+
+    // Create or truncate a file
+    explicit OutputSink(const std::string& filename, size_t bufferSize = size_t(1) << 20);
+    // Append to buffer, which must outlive the sink
+    explicit OutputSink(std::vector<char>& buffer, size_t bufferSize = size_t(1) << 16);
+    // Fill span from its start; bytesWritten() reports how much was used
+    explicit OutputSink(Span span, size_t bufferSize = size_t(1) << 16);
+    // Write to an open descriptor (pipe, socket, file); close() leaves it open
+    explicit OutputSink(int fd, size_t bufferSize = size_t(1) << 20);
+    ~OutputSink();
+
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    void write(const void* data, size_t size);
+
+    // Raw little-endian value, for binary formats such as STL
+    template <typename T>
+    void writeLittleEndian(T value) {
+        static_assert(std::is_arithmetic_v<T>, "arithmetic values only");
+        unsigned char bytes[sizeof(T)];
+        toLittleEndian(&value, bytes, sizeof(T));
+        write(bytes, sizeof(T));
+    }
+
+    OutputSink& operator<<(std::string_view text) {
+        write(text.data(), text.size());
+        return *this;
+    }
+    OutputSink& operator<<(const char* text) { return *this << std::string_view(text); }
+    OutputSink& operator<<(const std::string& text) { return *this << std::string_view(text); }
+    OutputSink& operator<<(char c) {
+        if (m_used == m_buffer.size()) drain();
+        m_buffer[m_used++] = c;
+        return *this;
+    }
+    OutputSink& operator<<(double value);
+    OutputSink& operator<<(float value);
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, char> &&
+                                                      !std::is_same_v<T, bool>>>
+    OutputSink& operator<<(T value) {
+        return writeInteger(static_cast<std::conditional_t<std::is_signed_v<T>, long long, unsigned long long>>(value));
+    }
+
+    // Hand all buffered data to the target; throws if any write failed
+    void flush();
+
+    // Flush and close the file; throws if any write failed. Memory, span and
+    // descriptor targets are flushed and released, not closed.
+    void close();
+
+    size_t bytesWritten() const { return m_written + m_used; }
+
+private:
+    OutputSink& writeInteger(long long value);
+    OutputSink& writeInteger(unsigned long long value);
+    static void toLittleEndian(const void* value, unsigned char* bytes, size_t size);
+    void drain();
+    void commit(const char* data, size_t size);
+
+    enum class Target { File, Memory, Span, Descriptor };
+
+    Target m_target;
+    bool m_open = true;
+    std::FILE* m_file = nullptr;
+    std::vector<char>* m_memory = nullptr;
+    char* m_span = nullptr;
+    size_t m_spanSize = 0;
+    int m_descriptor = -1;
+    std::string m_filename;  // Target description for error messages
+    std::vector<char> m_buffer;
+    size_t m_used = 0;
+    size_t m_written = 0;
+};
@@ -0,0 +1,27 @@
+// ParallelUtils.h
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+
+#include <OSD_Parallel.hxx>
+
+// Run body(begin, end) over [0, count) split into chunks of grainSize items.
+// Chunks are dispatched through OCCT's thread pool (OSD_Parallel), the same
+// scheduler BRepMesh and the boolean operations use when SetRunParallel is on.
+template <typename Body>
+inline void parallelForChunks(size_t count, size_t grainSize, const Body& body) {
+    if (count == 0) return;
+    if (grainSize == 0) grainSize = 1;
+
+    const size_t chunkCount = (count + grainSize - 1) / grainSize;
+    if (chunkCount == 1) {
+        body(size_t(0), count);
+        return;
+    }
+
+    OSD_Parallel::For(0, static_cast<int>(chunkCount), [&](int chunk) {
+        const size_t begin = static_cast<size_t>(chunk) * grainSize;
+        body(begin, std::min(count, begin + grainSize));
+    });
+}
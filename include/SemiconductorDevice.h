@@ -143,12 +143,17 @@ public:
     // Mesh operations
     void generateGlobalBoundaryMesh(double meshSize = 0.1);
     void refineGlobalMesh(const std::vector<gp_Pnt>& refinementPoints, double localSize);
+    void weldGlobalMesh(double tolerance);
     const BoundaryMesh* getGlobalMesh() const { return m_globalMesh.get(); }
     
     // Analysis and export
     void exportGeometry(const std::string& filename, const std::string& format = "STEP") const;
     void exportMesh(const std::string& filename, const std::string& format = "VTK") const;
     void exportMeshWithRegions(const std::string& filename, const std::string& format = "VTK") const;
+    // Gmsh MSH 4.1 binary: one surface entity per meshed layer (tag = layer
+    // position + 1), tagged with a physical group for its DeviceRegion
+    // (tags from 1) and one for its MaterialType (tags from 101)
+    void exportMeshToGmsh(const std::string& filename) const;
     
     // Utility functions
     std::vector<DeviceLayer*> getLayersByRegion(DeviceRegion region);
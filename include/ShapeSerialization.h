@@ -0,0 +1,12 @@
+// ShapeSerialization.h
+#pragma once
+
+#include <ostream>
+
+#include <TopoDS_Shape.hxx>
+
+// Binary BRep (BinTools format) of the shape without triangulations or
+// normals, readable with BinTools::Read. Covers surface and curve geometry,
+// tolerances, orientations and locations, so the output also serves as a
+// geometric fingerprint that doesn't change once a mesh is attached.
+void writeShapeWithoutMesh(const TopoDS_Shape& shape, std::ostream& stream);
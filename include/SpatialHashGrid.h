@@ -0,0 +1,65 @@
+// SpatialHashGrid.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Uniform hash grid over a point cloud given as separate x/y/z arrays.
+// Points are bucketed by the hash of their integer cell coordinates, so
+// construction and neighbourhood queries are linear in the point count.
+class SpatialHashGrid {
+public:
+    SpatialHashGrid(const double* x, const double* y, const double* z,
+                    size_t count, double cellSize);
+
+    struct WeldResult {
+        std::vector<std::int32_t> remap;            // input point -> welded point
+        std::vector<std::int32_t> representatives;  // welded point -> input point kept
+    };
+
+    // Merge points closer than tolerance. Each welded point keeps the
+    // coordinates of its lowest-index member, and welded points are numbered
+    // in order of first appearance, so the result is deterministic regardless
+    // of thread scheduling.
+    static WeldResult weldPoints(const double* x, const double* y, const double* z,
+                                 size_t count, double tolerance);
+
+    // Call visit(pointIndex) for every point stored in the 27 cells around
+    // (px, py, pz). Hash collisions can report points from unrelated cells,
+    // so callers must still check the actual distance.
+    template <typename Visitor>
+    void forEachNear(double px, double py, double pz, Visitor&& visit) const {
+        const std::int64_t cx = cellCoord(px), cy = cellCoord(py), cz = cellCoord(pz);
+        std::uint32_t visited[27];
+        int visitedCount = 0;
+        for (int dz = -1; dz <= 1; dz++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    const std::uint32_t bucket = bucketOf(cx + dx, cy + dy, cz + dz);
+                    bool seen = false;
+                    for (int k = 0; k < visitedCount; k++) {
+                        if (visited[k] == bucket) { seen = true; break; }
+                    }
+                    if (seen) continue;
+                    visited[visitedCount++] = bucket;
+                    for (std::uint32_t k = m_bucketOffsets[bucket]; k < m_bucketOffsets[bucket + 1]; k++) {
+                        visit(m_bucketPoints[k]);
+                    }
+                }
+            }
+        }
+    }
+
+    double getCellSize() const { return m_cellSize; }
+
+private:
+    std::int64_t cellCoord(double v) const;
+    std::uint32_t bucketOf(std::int64_t cx, std::int64_t cy, std::int64_t cz) const;
+
+    double m_cellSize;
+    double m_inverseCellSize;
+    std::uint32_t m_bucketMask;
+    std::vector<std::uint32_t> m_bucketOffsets;
+    std::vector<std::int32_t> m_bucketPoints;
+};
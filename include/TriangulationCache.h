@@ -0,0 +1,93 @@
+// TriangulationCache.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "BoundaryMesh.h"
+
+// Process-wide cache of face triangulations and the mesh arrays extracted
+// from them. Keys combine a geometric fingerprint of the shape with the
+// BRepMesh parameters, so a layer rebuilt with identical geometry (as in a
+// parameter sweep) reuses the previous result instead of remeshing.
+// Entries are evicted least-recently-used once the byte budget is exceeded.
+class TriangulationCache {
+public:
+    struct Key {
+        std::uint64_t shapeHash;
+        double deflection;
+        double angle;
+        bool operator==(Key const& o) const noexcept {
+            return shapeHash == o.shapeHash && deflection == o.deflection && angle == o.angle;
+        }
+    };
+
+    struct FaceRange {
+        int faceId;
+        std::int32_t firstElement;
+        std::int32_t elementCount;
+    };
+
+    // Extracted mesh data before welding, plus the triangulation of every
+    // face in TopExp_Explorer order (null for faces BRepMesh skipped) so a
+    // hit can be re-attached to the shape for later local refinement
+    struct MeshData {
+        std::vector<Handle(Poly_Triangulation)> triangulations;
+        MeshNodeArrays nodes;
+        std::vector<std::int32_t> triangles;
+        std::vector<std::int32_t> faceIds;
+        std::vector<FaceRange> faces;
+
+        size_t byteSize() const;
+    };
+
+    struct Statistics {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    explicit TriangulationCache(size_t max_bytes = 256u << 20);
+
+    static TriangulationCache& instance();
+
+    // Hash of the shape's binary BRep serialization without triangulations:
+    // topology, surface and curve geometry, tolerances, orientations and
+    // locations. Equal for shapes built the same way, also across runs, and
+    // unaffected by meshing the shape.
+    static std::uint64_t fingerprint(const TopoDS_Shape& shape);
+
+    std::shared_ptr<const MeshData> tryGet(const Key& key);
+    void put(const Key& key, std::shared_ptr<const MeshData> value);
+    void clear();
+
+    // A budget of 0 disables caching
+    void setMaxBytes(size_t max_bytes);
+    size_t getMaxBytes() const;
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+    void printStatistics() const;
+
+private:
+    struct KeyHash {
+        size_t operator()(Key const& k) const noexcept;
+    };
+    using Entry = std::pair<Key, std::shared_ptr<const MeshData>>;
+
+    void evictToBudget();
+
+    mutable std::mutex mtx_;
+    size_t max_bytes_;
+    size_t bytes_ = 0;
+    Statistics stats_;
+    std::list<Entry> lru_;  // most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+};
@@ -3,16 +3,26 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
 #include <memory>
 
+#include "VTKGridWriter.h"
+
 // Forward declarations
+class OutputSink;
 class SemiconductorDevice;
 class BoundaryMesh;
 class DeviceLayer;
 enum class MaterialType;
 enum class DeviceRegion;
 
+/**
+ * @brief How exportDevicePartitioned splits a device mesh into pieces
+ */
+enum class VTKPartitioning {
+    ByLayer,   // One piece per meshed layer
+    Spatial    // Equal-count slabs of cell centroids along the longest extent
+};
+
 /**
  * @brief Utility class for exporting 3D geometry and mesh data to VTK format
  * 
@@ -22,7 +32,12 @@ enum class DeviceRegion;
  * layer indices, element quality metrics, and areas.
  * 
  * VTK (Visualization Toolkit) files can be visualized using ParaView, VisIt,
- * or other scientific visualization tools.
+ * or other scientific visualization tools. Every export entry point takes a
+ * VTKWriteOptions selecting legacy ASCII (default), legacy big-endian binary,
+ * or XML .vtu with raw appended binary data and optional zlib compression.
+ * Each entry point also has an overload writing to an OutputSink (memory
+ * buffer, caller span or file descriptor) instead of a named file; those
+ * overloads flush but do not close the sink and print nothing on success.
  */
 class VTKExporter {
 public:
@@ -31,9 +46,22 @@ public:
      * 
      * @param mesh The boundary mesh to export
      * @param filename Output VTK filename
+     * @param options Output format selection
      * @return true if export was successful, false otherwise
      */
-    static bool exportMesh(const BoundaryMesh& mesh, const std::string& filename);
+    static bool exportMesh(const BoundaryMesh& mesh, const std::string& filename,
+                           const VTKWriteOptions& options = VTKWriteOptions());
+
+    /**
+     * @brief Export a single boundary mesh to an output sink
+     * 
+     * @param mesh The boundary mesh to export
+     * @param out Destination sink
+     * @param options Output format selection
+     * @return true if export was successful, false otherwise
+     */
+    static bool exportMesh(const BoundaryMesh& mesh, OutputSink& out,
+                           const VTKWriteOptions& options = VTKWriteOptions());
 
     /**
      * @brief Export a boundary mesh to VTK format with custom material and region data
@@ -47,13 +75,31 @@ public:
      * @param materialIds Vector of material IDs for each element
      * @param regionIds Vector of region IDs for each element
      * @param layerNames Vector of layer names (currently unused but kept for compatibility)
+     * @param options Output format selection
      * @return true if export was successful, false otherwise
      */
     static bool exportMeshWithCustomData(const BoundaryMesh& mesh, 
                                         const std::string& filename,
                                         const std::vector<int>& materialIds, 
                                         const std::vector<int>& regionIds, 
-                                        const std::vector<std::string>& layerNames = {});
+                                        const std::vector<std::string>& layerNames = {},
+                                        const VTKWriteOptions& options = VTKWriteOptions());
+
+    /**
+     * @brief Export mesh with custom material and region data to an output sink
+     * 
+     * @param mesh The boundary mesh to export
+     * @param out Destination sink
+     * @param materialIds Vector of material IDs for each element
+     * @param regionIds Vector of region IDs for each element
+     * @param options Output format selection
+     * @return true if export was successful, false otherwise
+     */
+    static bool exportMeshWithCustomData(const BoundaryMesh& mesh,
+                                        OutputSink& out,
+                                        const std::vector<int>& materialIds,
+                                        const std::vector<int>& regionIds,
+                                        const VTKWriteOptions& options = VTKWriteOptions());
 
     /**
      * @brief Export a boundary mesh with enhanced region information
@@ -69,12 +115,30 @@ public:
      * @param layer The device layer containing material and region information
      * @param layerIndex Index of this layer in the device
      * @param filename Output VTK filename
+     * @param options Output format selection
      * @return true if export was successful, false otherwise
      */
     static bool exportMeshWithRegions(const BoundaryMesh& mesh, 
                                      const DeviceLayer& layer,
                                      int layerIndex,
-                                     const std::string& filename);
+                                     const std::string& filename,
+                                     const VTKWriteOptions& options = VTKWriteOptions());
+
+    /**
+     * @brief Export mesh with region information to an output sink
+     * 
+     * @param mesh The boundary mesh to export
+     * @param layer The device layer containing material and region information
+     * @param layerIndex Index of the layer in the device
+     * @param out Destination sink
+     * @param options Output format selection
+     * @return true if export was successful, false otherwise
+     */
+    static bool exportMeshWithRegions(const BoundaryMesh& mesh,
+                                     const DeviceLayer& layer,
+                                     int layerIndex,
+                                     OutputSink& out,
+                                     const VTKWriteOptions& options = VTKWriteOptions());
 
     /**
      * @brief Export multiple device layers as a single merged VTK file
@@ -85,10 +149,79 @@ public:
      * 
      * @param device The semiconductor device containing all layers
      * @param filename Output VTK filename
+     * @param options Output format selection
      * @return true if export was successful, false otherwise
      */
     static bool exportDeviceWithRegions(const SemiconductorDevice& device, 
-                                       const std::string& filename);
+                                       const std::string& filename,
+                                       const VTKWriteOptions& options = VTKWriteOptions());
+
+    /**
+     * @brief Export all device layers with region information to an output sink
+     * 
+     * @param device The semiconductor device containing multiple layers
+     * @param out Destination sink
+     * @param options Output format selection
+     * @return true if export was successful, false otherwise
+     */
+    static bool exportDeviceWithRegions(const SemiconductorDevice& device,
+                                       OutputSink& out,
+                                       const VTKWriteOptions& options = VTKWriteOptions());
+
+    /**
+     * @brief Export all device layers on a single conformal point set
+     * 
+     * Like exportDeviceWithRegions, but nodes from different layers that lie
+     * within tolerance of each other (layer interfaces) are welded through a
+     * spatial hash, so interface cells of neighbouring layers share nodes.
+     * Every cell keeps its MaterialID, RegionID and LayerIndex tags; cells
+     * that collapse under the weld are dropped.
+     * 
+     * @param device The semiconductor device containing multiple layers
+     * @param filename Output VTK filename
+     * @param tolerance Distance below which nodes are merged
+     * @param options Output format selection
+     * @return true if export was successful, false otherwise
+     */
+    static bool exportDeviceWelded(const SemiconductorDevice& device,
+                                   const std::string& filename,
+                                   double tolerance = 1e-9,
+                                   const VTKWriteOptions& options = VTKWriteOptions());
+
+    /**
+     * @brief Export all device layers on a conformal point set to an output sink
+     * 
+     * @param device The semiconductor device containing multiple layers
+     * @param out Destination sink
+     * @param tolerance Distance below which nodes are merged
+     * @param options Output format selection
+     * @return true if export was successful, false otherwise
+     */
+    static bool exportDeviceWelded(const SemiconductorDevice& device,
+                                   OutputSink& out,
+                                   double tolerance = 1e-9,
+                                   const VTKWriteOptions& options = VTKWriteOptions());
+
+    /**
+     * @brief Export all device layers as concurrently written .vtu pieces
+     * 
+     * The merged device mesh (same cell arrays as exportDeviceWithRegions) is
+     * split into pieces that are gathered and written in parallel as
+     * <stem>_<k>.vtu, with a .pvtu index at filename so ParaView can load
+     * the pieces in parallel as well.
+     * 
+     * @param device The semiconductor device containing multiple layers
+     * @param filename Output .pvtu filename
+     * @param partitioning Split by layer or by spatial slabs
+     * @param pieceCount Number of spatial pieces (0 = one per logical processor; ignored for ByLayer)
+     * @param compress zlib-compress the piece arrays
+     * @return true if export was successful, false otherwise
+     */
+    static bool exportDevicePartitioned(const SemiconductorDevice& device,
+                                        const std::string& filename,
+                                        VTKPartitioning partitioning = VTKPartitioning::ByLayer,
+                                        size_t pieceCount = 0,
+                                        bool compress = false);
 
     /**
      * @brief Convert MaterialType enum to integer ID
@@ -122,45 +255,108 @@ public:
      */
     static std::string deviceRegionToName(DeviceRegion region);
 
+private:
+
     /**
-     * @brief Write VTK file header
+     * @brief Write a grid and report failures on stderr
      * 
-     * @param file Output file stream
-     * @param title Title for the VTK file
+     * @param grid Assembled triangle grid
+     * @param filename Output filename
+     * @param title Title for legacy VTK files
+     * @param options Output format selection
+     * @return true if the file was written, false otherwise
      */
-    static void writeVTKHeader(std::ofstream& file, const std::string& title);
+    static bool writeGrid(const VTKTriangleGrid& grid,
+                          const std::string& filename,
+                          const std::string& title,
+                          const VTKWriteOptions& options);
 
     /**
-     * @brief Write mesh points to VTK file
+     * @brief Write a grid to a sink and report failures on stderr
      * 
-     * @param file Output file stream
-     * @param mesh Boundary mesh containing point data
+     * @param grid Assembled triangle grid
+     * @param out Destination sink (flushed, not closed)
+     * @param title Title for legacy VTK files
+     * @param options Output format selection
+     * @return true if the data was written, false otherwise
      */
-    static void writeVTKPoints(std::ofstream& file, const BoundaryMesh& mesh);
+    static bool writeGrid(const VTKTriangleGrid& grid,
+                          OutputSink& out,
+                          const std::string& title,
+                          const VTKWriteOptions& options);
 
     /**
-     * @brief Write mesh triangular cells to VTK file
+     * @brief Append a mesh's points and offset triangles to a grid
      * 
-     * @param file Output file stream
-     * @param mesh Boundary mesh containing triangle data
-     * @param pointOffset Offset to add to point indices (for merged meshes)
+     * @param grid Grid to extend
+     * @param mesh Boundary mesh to append
      */
-    static void writeVTKCells(std::ofstream& file, const BoundaryMesh& mesh, int pointOffset = 0);
+    static void appendMeshGeometry(VTKTriangleGrid& grid, const BoundaryMesh& mesh);
 
-private:
+    /**
+     * @brief Build a mesh grid with caller-supplied material and region ids
+     * 
+     * @param mesh Boundary mesh to export
+     * @param materialIds Per-element material IDs (skipped if too short)
+     * @param regionIds Per-element region IDs (skipped if too short)
+     * @param grid Empty grid to fill
+     */
+    static void buildCustomDataGrid(const BoundaryMesh& mesh,
+                                    const std::vector<int>& materialIds,
+                                    const std::vector<int>& regionIds,
+                                    VTKTriangleGrid& grid);
 
     /**
-     * @brief Write cell data arrays to VTK file
+     * @brief Build a mesh grid tagged with one layer's material and region
      * 
-     * @param file Output file stream
-     * @param mesh Boundary mesh for quality and area calculations
-     * @param layer Device layer for material and region information
+     * @param mesh Boundary mesh to export
+     * @param layer Layer providing the material and region
      * @param layerIndex Index of the layer in the device
+     * @param grid Empty grid to fill
+     */
+    static void buildLayerGrid(const BoundaryMesh& mesh,
+                               const DeviceLayer& layer,
+                               int layerIndex,
+                               VTKTriangleGrid& grid);
+
+    /**
+     * @brief Collect the device layers that have a non-empty boundary mesh
+     * 
+     * @param device The semiconductor device
+     * @param meshes Receives the layer meshes in layer order
+     * @param layers Receives the layer owning each mesh
+     */
+    static void collectLayerMeshes(const SemiconductorDevice& device,
+                                   std::vector<const BoundaryMesh*>& meshes,
+                                   std::vector<const DeviceLayer*>& layers);
+
+    /**
+     * @brief Assemble several layer meshes into one grid in a single pass
+     * 
+     * Per-layer node and cell offsets are computed up front and every buffer
+     * is sized once; points, connectivity and the MaterialID, RegionID,
+     * LayerIndex, ElementQuality and ElementArea arrays are then filled
+     * together, in parallel, from one traversal of the cells.
+     * 
+     * @param meshes Layer meshes in output order
+     * @param layers Layer owning each mesh
+     * @param grid Grid to fill (replaced)
+     */
+    static void buildDeviceGrid(const std::vector<const BoundaryMesh*>& meshes,
+                                const std::vector<const DeviceLayer*>& layers,
+                                VTKTriangleGrid& grid);
+
+    /**
+     * @brief Merge grid points closer than tolerance and renumber the cells
+     * 
+     * Degenerate cells left by the merge are removed together with their
+     * cell data.
+     * 
+     * @param grid Grid to weld in place
+     * @param tolerance Distance below which points are merged
+     * @return Number of cells removed
      */
-    static void writeVTKCellData(std::ofstream& file, 
-                                const BoundaryMesh& mesh,
-                                const DeviceLayer& layer,
-                                int layerIndex);
+    static size_t weldGrid(VTKTriangleGrid& grid, double tolerance);
 
     /**
      * @brief Calculate triangular element quality metric
@@ -0,0 +1,97 @@
+// VTKGridWriter.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class OutputSink;
+
+/**
+ * @brief Output encodings supported by VTKExporter
+ */
+enum class VTKFormat {
+    LegacyASCII,   // .vtk text
+    LegacyBinary,  // .vtk with big-endian binary arrays
+    XMLBinary      // .vtu XML UnstructuredGrid with raw appended binary data
+};
+
+/**
+ * @brief Output selection for VTKExporter entry points
+ */
+struct VTKWriteOptions {
+    VTKFormat format = VTKFormat::LegacyASCII;
+    bool compress = false;  // zlib-compress .vtu arrays; ignored when built without zlib
+};
+
+/**
+ * @brief Named per-cell array of 32-bit integers or floats
+ */
+struct VTKCellArray {
+    std::string name;
+    bool isFloat = false;
+    std::vector<std::int32_t> ints;
+    std::vector<float> floats;
+
+    size_t size() const { return isFloat ? floats.size() : ints.size(); }
+};
+
+/**
+ * @brief Triangle unstructured grid in contiguous arrays, ready to write
+ */
+struct VTKTriangleGrid {
+    std::vector<double> points;              // Interleaved xyz
+    std::vector<std::int32_t> connectivity;  // Three point indices per triangle
+    std::vector<VTKCellArray> cellData;      // add*Array references are invalidated by later adds unless reserved
+
+    size_t pointCount() const { return points.size() / 3; }
+    size_t cellCount() const { return connectivity.size() / 3; }
+
+    VTKCellArray& addIntArray(const std::string& name) {
+        cellData.emplace_back();
+        cellData.back().name = name;
+        cellData.back().ints.resize(cellCount());
+        return cellData.back();
+    }
+    VTKCellArray& addFloatArray(const std::string& name) {
+        cellData.emplace_back();
+        cellData.back().name = name;
+        cellData.back().isFloat = true;
+        cellData.back().floats.resize(cellCount());
+        return cellData.back();
+    }
+    const VTKCellArray* findArray(const std::string& name) const {
+        for (const VTKCellArray& array : cellData) {
+            if (array.name == name) return &array;
+        }
+        return nullptr;
+    }
+};
+
+// Writes a VTKTriangleGrid in any VTKFormat through OutputSink. Binary
+// arrays are converted (byte-swapped or compressed) in parallel and written
+// as whole blocks. Throws std::runtime_error on I/O errors.
+class VTKGridWriter {
+public:
+    static void write(const VTKTriangleGrid& grid, const std::string& filename,
+                      const std::string& title, const VTKWriteOptions& options);
+
+    // Write to any sink (memory, span, descriptor); the sink is flushed, not closed
+    static void write(const VTKTriangleGrid& grid, OutputSink& out,
+                      const std::string& title, const VTKWriteOptions& options);
+
+    // Split the grid into pieces (cellPiece[c] in [0, pieceCount)) and write
+    // each non-empty piece concurrently as <stem>_<k>.vtu next to filename,
+    // plus a .pvtu index at filename referencing them. Returns the number of
+    // pieces written.
+    static size_t writePartitioned(const VTKTriangleGrid& grid,
+                                   const std::vector<std::int32_t>& cellPiece,
+                                   size_t pieceCount, const std::string& filename,
+                                   bool compress);
+
+    // Sub-grid of the listed cells with its points compacted and renumbered
+    static VTKTriangleGrid extractCells(const VTKTriangleGrid& grid, const std::vector<size_t>& cells);
+
+    static bool hasCompression();
+};
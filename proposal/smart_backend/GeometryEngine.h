@@ -4,6 +4,8 @@
 #include "../include/SemiconductorDevice.h"
 #include "../include/GeometryBuilder.h"
 #include "../include/VTKExporter.h"
+#include "../include/OutputSink.h"
+#include "../include/GLBExporter.h"
 #include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
@@ -123,6 +125,8 @@ public:
     
     // VTK export (uses your existing VTKExporter - unchanged)
     std::string exportCurrentVTK() const;
+    // Binary glTF for Three.js GLTFLoader; replaces the JSON vertex arrays
+    std::vector<char> exportCurrentGLB() const;
     void exportVTKToFile(const std::string& filename) const;
     void exportSTEPToFile(const std::string& filename) const;
     void exportAllFormats(const std::string& basePath) const;
@@ -190,26 +194,31 @@ inline CommandResult GeometryEngine::generateMesh(double meshSize) {
     }
 }
 
-// VTK export - uses your existing VTKExporter (completely unchanged)
+// VTK export - VTKExporter writes straight into a memory buffer, no temp file
 inline std::string GeometryEngine::exportCurrentVTK() const {
     if (!m_device) return "";
     
-    // Use your existing VTK export capability
-    std::string tempFile = "/tmp/device_" + std::to_string(rand()) + ".vtk";
-    
-    // Your existing method works exactly as before
-    bool success = m_device->exportMesh(tempFile, "VTK");
+    const BoundaryMesh* mesh = m_device->getGlobalMesh();
+    if (!mesh) return "";
     
-    if (success) {
-        // Read file content and return as string
-        std::ifstream file(tempFile);
-        std::string content((std::istreambuf_iterator<char>(file)),
-                           std::istreambuf_iterator<char>());
-        std::remove(tempFile.c_str());  // Clean up temp file
-        return content;
+    std::vector<char> buffer;
+    OutputSink out(buffer);
+    if (!VTKExporter::exportMesh(*mesh, out)) {
+        return "";
     }
+    return std::string(buffer.begin(), buffer.end());
+}
+
+// Binary glTF straight from the layer meshes, servable as model/gltf-binary
+inline std::vector<char> GeometryEngine::exportCurrentGLB() const {
+    std::vector<char> buffer;
+    if (!m_device) return buffer;
     
-    return "";
+    OutputSink out(buffer);
+    if (!GLBExporter::exportDevice(*m_device, out)) {
+        buffer.clear();
+    }
+    return buffer;
 }
 
 // Simple data extraction for Three.js (not complex VTK processing)
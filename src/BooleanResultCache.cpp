@@ -0,0 +1,342 @@
+// BooleanResultCache.cpp
+#include "BooleanResultCache.h"
+#include "ShapeSerialization.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <BinTools.hxx>
+#include <Standard_Failure.hxx>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char kEntryMagic[8] = {'S', 'D', 'B', 'O', 'O', 'L', '0', '1'};
+const char* const kEntryExtension = ".bbrep";
+// Eviction goes down to this fraction of the cap, so a full cache is listed
+// once per tenth of the cap written rather than on every store
+const double kEvictionTarget = 0.9;
+
+// FNV-1a over raw bytes
+struct Fnv1a {
+    std::uint64_t h = 14695981039346656037ULL;
+    void bytes(const void* data, size_t n) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < n; i++) {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+    }
+    void value(double v) {
+        if (v == 0.0) v = 0.0;  // fold -0.0 into +0.0
+        bytes(&v, sizeof(v));
+    }
+    void value(std::uint64_t v) { bytes(&v, sizeof(v)); }
+};
+
+// Fixed-size header in front of the BinTools data, checked on every read.
+// It rejects files of another format and keys that only share a file name;
+// operands whose 64-bit fingerprints collide still get each other's result.
+struct EntryHeader {
+    char magic[8];
+    std::uint64_t first;
+    std::uint64_t second;
+    std::int32_t operation;
+    double fuzzy;
+};
+
+EntryHeader headerFor(const BooleanResultCache::Key& key) {
+    EntryHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kEntryMagic, sizeof(kEntryMagic));
+    header.first = key.first;
+    header.second = key.second;
+    header.operation = static_cast<std::int32_t>(key.operation);
+    header.fuzzy = key.fuzzy;
+    return header;
+}
+
+bool sameHeader(const EntryHeader& a, const EntryHeader& b) {
+    return std::memcmp(a.magic, b.magic, sizeof(a.magic)) == 0
+        && a.first == b.first && a.second == b.second
+        && a.operation == b.operation && a.fuzzy == b.fuzzy;
+}
+
+} // namespace
+
+BooleanResultCache& BooleanResultCache::instance() {
+    static BooleanResultCache cache;
+    return cache;
+}
+
+std::uint64_t BooleanResultCache::fingerprint(const TopoDS_Shape& shape) {
+    Fnv1a f;
+    if (shape.IsNull()) return f.h;
+
+    // The binary serialization covers topology, geometry, tolerances,
+    // orientations and locations, and is identical across processes for
+    // shapes built the same way. Triangulations and normals are left out, so
+    // meshing an operand doesn't change its fingerprint.
+    std::ostringstream stream(std::ios::out | std::ios::binary);
+    writeShapeWithoutMesh(shape, stream);
+    const std::string data = stream.str();
+    f.bytes(data.data(), data.size());
+    return f.h;
+}
+
+BooleanResultCache::Key BooleanResultCache::makeKey(Operation operation, const TopoDS_Shape& first,
+                                                    const TopoDS_Shape& second, double fuzzy) {
+    Key key;
+    key.first = fingerprint(first);
+    key.second = fingerprint(second);
+    key.operation = operation;
+    key.fuzzy = fuzzy;
+    return key;
+}
+
+void BooleanResultCache::setDirectory(const std::string& directory) {
+    if (!directory.empty()) {
+        std::error_code ec;
+        fs::create_directories(directory, ec);
+        if (ec) {
+            std::cerr << "Warning: boolean result cache disabled, cannot create " << directory
+                      << ": " << ec.message() << std::endl;
+            std::lock_guard<std::mutex> lock(mtx_);
+            directory_.clear();
+            return;
+        }
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    directory_ = directory;
+    size_known_ = false;
+}
+
+std::string BooleanResultCache::getDirectory() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return directory_;
+}
+
+bool BooleanResultCache::isEnabled() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return !directory_.empty();
+}
+
+void BooleanResultCache::setMaxBytes(size_t max_bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        max_bytes_ = max_bytes;
+    }
+    evictToBudget();
+}
+
+size_t BooleanResultCache::getMaxBytes() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return max_bytes_;
+}
+
+std::string BooleanResultCache::entryPath(const Key& key) const {
+    Fnv1a f;
+    f.value(key.first);
+    f.value(key.second);
+    f.value(static_cast<std::uint64_t>(key.operation));
+    f.value(key.fuzzy);
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(f.h));
+    return (fs::path(getDirectory()) / (std::string(name) + kEntryExtension)).string();
+}
+
+bool BooleanResultCache::tryGet(const Key& key, TopoDS_Shape& result) {
+    if (!isEnabled()) return false;
+    const std::string path = entryPath(key);
+
+    TopoDS_Shape shape;
+    bool found = false;
+    {
+        std::ifstream in(path, std::ios::in | std::ios::binary);
+        if (in) {
+            EntryHeader header;
+            in.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (in && sameHeader(header, headerFor(key))) {
+                try {
+                    BinTools::Read(shape, in);
+                    found = !shape.IsNull();
+                } catch (const Standard_Failure&) {
+                    found = false;
+                }
+            }
+            if (!found) {
+                // Corrupt or colliding entry: drop it so the result is stored afresh
+                in.close();
+                std::error_code ec;
+                fs::remove(path, ec);
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!found) {
+        stats_.misses++;
+        return false;
+    }
+    stats_.hits++;
+
+    // Mark as recently used for eviction, across processes too
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    result = shape;
+    return true;
+}
+
+void BooleanResultCache::put(const Key& key, const TopoDS_Shape& result) {
+    if (!isEnabled() || result.IsNull()) return;
+    const std::string path = entryPath(key);
+
+    // Unique temporary name per process and thread, renamed into place once
+    // complete
+    std::ostringstream suffix;
+    suffix << ".tmp." << std::chrono::steady_clock::now().time_since_epoch().count()
+           << "." << std::this_thread::get_id();
+    const std::string temporary = path + suffix.str();
+
+    // Size of the entry being replaced, if any, for the running total
+    std::error_code ec;
+    std::uintmax_t replaced = fs::file_size(path, ec);
+    if (ec) replaced = 0;
+
+    bool written = false;
+    try {
+        std::ofstream out(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (out) {
+            // Geometry only: meshes are rebuilt by the reader when needed
+            const EntryHeader header = headerFor(key);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            writeShapeWithoutMesh(result, out);
+            out.close();
+            written = !out.fail();
+        }
+    } catch (const Standard_Failure&) {
+        written = false;
+    }
+
+    std::uintmax_t size = 0;
+    if (written) {
+        size = fs::file_size(temporary, ec);
+        written = !ec;
+    }
+    if (written) {
+        fs::rename(temporary, path, ec);
+        written = !ec;
+    }
+    if (!written) {
+        fs::remove(temporary, ec);
+        std::cerr << "Warning: could not store boolean result in " << path << std::endl;
+        return;
+    }
+
+    // The directory is only scanned when the running total crosses the cap
+    // (or isn't known yet); entries other processes add are picked up then
+    bool overBudget;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stats_.stores++;
+        known_bytes_ += size;
+        known_bytes_ -= std::min(replaced, known_bytes_);
+        overBudget = !size_known_ || known_bytes_ > max_bytes_;
+    }
+    if (overBudget) {
+        evictToBudget();
+    }
+}
+
+void BooleanResultCache::clear() {
+    const std::string directory = getDirectory();
+    if (directory.empty()) return;
+
+    std::error_code ec;
+    for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() == kEntryExtension) {
+            std::error_code removeError;
+            fs::remove(it->path(), removeError);
+        }
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    size_known_ = false;
+}
+
+BooleanResultCache::Statistics BooleanResultCache::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return stats_;
+}
+
+void BooleanResultCache::resetStatistics() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stats_ = Statistics();
+}
+
+void BooleanResultCache::printStatistics() const {
+    const Statistics stats = getStatistics();
+    const size_t lookups = stats.hits + stats.misses;
+    std::cout << "=== Boolean Result Cache ===" << std::endl;
+    std::cout << "Directory: " << (isEnabled() ? getDirectory() : std::string("<disabled>")) << std::endl;
+    std::cout << "Hits: " << stats.hits << ", misses: " << stats.misses
+              << ", stores: " << stats.stores << ", evictions: " << stats.evictions << std::endl;
+    if (lookups > 0) {
+        std::cout << "Hit rate: " << (100.0 * stats.hits / lookups) << "%" << std::endl;
+    }
+}
+
+void BooleanResultCache::evictToBudget() {
+    const std::string directory = getDirectory();
+    if (directory.empty()) return;
+    const size_t maxBytes = getMaxBytes();
+
+    struct StoredEntry {
+        fs::file_time_type time;
+        std::uintmax_t size;
+        fs::path path;
+    };
+    std::vector<StoredEntry> entries;
+    std::uintmax_t total = 0;
+    size_t evicted = 0;
+    std::error_code ec;
+    for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() != kEntryExtension) continue;
+        std::error_code statError;
+        StoredEntry entry;
+        entry.size = fs::file_size(it->path(), statError);
+        if (statError) continue;
+        entry.time = fs::last_write_time(it->path(), statError);
+        if (statError) continue;
+        entry.path = it->path();
+        total += entry.size;
+        entries.push_back(entry);
+    }
+    if (total > maxBytes) {
+        const std::uintmax_t target = static_cast<std::uintmax_t>(maxBytes * kEvictionTarget);
+        // Oldest first; another process may delete the same files concurrently
+        std::sort(entries.begin(), entries.end(),
+                  [](const StoredEntry& a, const StoredEntry& b) { return a.time < b.time; });
+        for (const StoredEntry& entry : entries) {
+            if (total <= target) break;
+            std::error_code removeError;
+            if (fs::remove(entry.path, removeError)) {
+                evicted++;
+            }
+            total -= entry.size;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    stats_.evictions += evicted;
+    known_bytes_ = total;
+    size_known_ = true;
+}
@@ -1,16 +1,30 @@
 #include "BoundaryMesh.h"
+#include "MeshFileReader.h"
+#include "OutputSink.h"
+#include "ParallelUtils.h"
+#include "SpatialHashGrid.h"
+#include "TriangulationCache.h"
 
 #include <iostream>
 #include <fstream>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
 #include <set>
 #include <limits>
+#include <atomic>
+#include <unordered_set>
 
 // OpenCASCADE includes
 #include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <BRep_Builder.hxx>
+#include <TopExp.hxx>
 #include <TopExp_Explorer.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopTools_ListIteratorOfListOfShape.hxx>
 #include <BRep_Tool.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
 #include <Poly_Connect.hxx>
@@ -19,34 +33,54 @@
 #include <BRepGProp.hxx>
 #include <GProp_GProps.hxx>
 #include <gp_Vec.hxx>
+#include <OSD_Parallel.hxx>
+#include <Geom_Surface.hxx>
+#include <GeomAdaptor_Surface.hxx>
+#include <GeomAPI_ProjectPointOnSurf.hxx>
+#include <gp_Pln.hxx>
+
+namespace {
+// Angular deflection passed to BRepMesh (its default), part of the cache key
+const double kAngularDeflection = 0.5;
+}
 
 BoundaryMesh::BoundaryMesh(const TopoDS_Shape& shape, double meshSize)
-    : m_shape(shape), m_meshSize(meshSize), m_minMeshSize(meshSize * 0.1), 
+    : m_viewValid(false), m_qualityValid(false), m_shape(shape), m_meshSize(meshSize), m_minMeshSize(meshSize * 0.1), 
       m_maxMeshSize(meshSize * 10.0), m_minAngle(0.0), m_maxAngle(0.0), 
-      m_avgElementQuality(0.0) {
+      m_avgElementQuality(0.0), m_weldTolerance(0.0), m_useTriangulationCache(true) {
+}
+
+void BoundaryMesh::clearMeshData() {
+    m_nodes.clear();
+    m_elements.clear();
+    m_faces.clear();
+    m_nodeElements.clear();
+    m_nodeNeighbors.clear();
+    m_faceNodes.clear();
+    m_faceIndexById.clear();
+    invalidateCompatibilityView();
+    invalidateSpatialIndex();
+    invalidateQualityCache();
 }
 
 void BoundaryMesh::generate() {
     try {
         // Clear existing mesh data
-        m_nodes.clear();
-        m_elements.clear();
-        m_faces.clear();
-        
-        // Generate triangulation
-        generateTriangulation();
-        
-        // Extract mesh data from OpenCASCADE triangulation
-        extractMeshData();
-        
-        // Calculate element properties
-        calculateElementProperties();
+        clearMeshData();
         
-        // Build connectivity information
-        buildConnectivity();
+        // Reuse the triangulation of identical geometry if one is cached,
+        // otherwise triangulate and extract the mesh data from OpenCASCADE
+        const std::uint64_t shapeHash = m_useTriangulationCache ? TriangulationCache::fingerprint(m_shape) : 0;
+        if (!m_useTriangulationCache || !loadCachedTriangulation(shapeHash)) {
+            generateTriangulation();
+            extractMeshData();
+            if (m_useTriangulationCache) {
+                storeCachedTriangulation(shapeHash);
+            }
+        }
         
-        // Analyze mesh quality
-        analyzeMeshQuality();
+        // Build the remaining mesh data
+        assembleMesh();
         
         std::cout << "Boundary mesh generated: " << getNodeCount() 
                   << " nodes, " << getElementCount() << " elements" << std::endl;
@@ -59,7 +93,7 @@ void BoundaryMesh::generate() {
 
 void BoundaryMesh::generateTriangulation() {
     // Use OpenCASCADE incremental mesh algorithm
-    BRepMesh_IncrementalMesh meshAlgo(m_shape, m_meshSize);
+    BRepMesh_IncrementalMesh meshAlgo(m_shape, m_meshSize, Standard_False, kAngularDeflection);
     meshAlgo.Perform();
     
     if (!meshAlgo.IsDone()) {
@@ -67,20 +101,41 @@ void BoundaryMesh::generateTriangulation() {
     }
 }
 
+void BoundaryMesh::assembleMesh() {
+    // Merge nodes duplicated along face seams
+    if (m_weldTolerance > 0.0) {
+        weldCoincidentNodes(m_weldTolerance);
+    }
+    
+    // Calculate element properties
+    calculateElementProperties();
+    
+    // Build connectivity information
+    buildConnectivity();
+    
+    // Analyze mesh quality
+    analyzeMeshQuality();
+}
+
 void BoundaryMesh::extractMeshData() {
+    // Pass 1: collect triangulated faces and compute per-face prefix offsets
+    struct FaceSlice {
+        Handle(Poly_Triangulation) triangulation;
+        TopLoc_Location location;
+        size_t nodeOffset;
+        size_t elementOffset;
+    };
+    std::vector<FaceSlice> slices;
+    
     TopExp_Explorer faceExp(m_shape, TopAbs_FACE);
     int faceId = 0;
-    int nodeOffset = 0;
-    int elementId = 0;
+    size_t nodeOffset = 0;
+    size_t elementOffset = 0;
     
     for (; faceExp.More(); faceExp.Next(), faceId++) {
         TopoDS_Face face;
         face = TopoDS::Face(faceExp.Current());
         
-        // Create boundary face
-        auto boundaryFace = std::make_unique<BoundaryFace>(face, faceId, 
-                                                          "Face_" + std::to_string(faceId));
-        
         // Get triangulation from face
         TopLoc_Location location;
         Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(face, location);
@@ -89,84 +144,422 @@ void BoundaryMesh::extractMeshData() {
             continue;
         }
         
+        // Create boundary face
+        auto boundaryFace = std::make_unique<BoundaryFace>(face, faceId, 
+                                                          "Face_" + std::to_string(faceId));
+        
+        const int nodeCount = triangulation->Nodes().Length();
+        const int triangleCount = triangulation->Triangles().Length();
+        
+        boundaryFace->elements = {static_cast<std::int32_t>(elementOffset), triangleCount};
+        m_faces.push_back(std::move(boundaryFace));
+        
+        slices.push_back({triangulation, location, nodeOffset, elementOffset});
+        nodeOffset += nodeCount;
+        elementOffset += triangleCount;
+    }
+    
+    if (nodeOffset > static_cast<size_t>(std::numeric_limits<std::int32_t>::max())) {
+        throw std::runtime_error("Mesh node count exceeds 32-bit index range");
+    }
+    
+    m_nodes.resize(nodeOffset);
+    m_elements.resize(elementOffset);
+    
+    // Pass 2: fill the preallocated arrays from all faces concurrently.
+    // Each face writes only its own [offset, offset + count) slice, so the
+    // result is identical to a serial traversal.
+    OSD_Parallel::For(0, static_cast<int>(slices.size()), [&](int s) {
+        const FaceSlice& slice = slices[s];
+        const int sliceFaceId = m_faces[s]->id;
+        
         // Extract nodes using modern OCCT 7.5+ API - direct array access
-        const TColgp_Array1OfPnt& nodes = triangulation->Nodes();
-        for (int i = nodes.Lower(); i <= nodes.Upper(); ++i) {
+        const TColgp_Array1OfPnt& nodes = slice.triangulation->Nodes();
+        const bool transformed = !slice.location.IsIdentity();
+        const gp_Trsf& trsf = slice.location.Transformation();
+        
+        size_t n = slice.nodeOffset;
+        for (int i = nodes.Lower(); i <= nodes.Upper(); ++i, ++n) {
             gp_Pnt point = nodes.Value(i);
-            if (!location.IsIdentity()) {
-                point.Transform(location.Transformation());
+            if (transformed) {
+                point.Transform(trsf);
             }
-
-            auto meshNode = std::make_unique<MeshNode>(point, nodeOffset + i - nodes.Lower());
-            m_nodes.push_back(std::move(meshNode));
+            m_nodes.x[n] = point.X();
+            m_nodes.y[n] = point.Y();
+            m_nodes.z[n] = point.Z();
         }
-
+        
         // Extract triangles using modern OCCT 7.5+ API - direct array access
-        const Poly_Array1OfTriangle& triangles = triangulation->Triangles();
+        const Poly_Array1OfTriangle& triangles = slice.triangulation->Triangles();
+        const std::int32_t base = static_cast<std::int32_t>(slice.nodeOffset) - nodes.Lower();
+        std::int32_t* tri = m_elements.triangles.data() + 3 * slice.elementOffset;
+        std::int32_t* faceIds = m_elements.faceIds.data() + slice.elementOffset;
         for (int i = triangles.Lower(); i <= triangles.Upper(); ++i) {
-            const Poly_Triangle& triangle = triangles.Value(i);
             int n1, n2, n3;
-            triangle.Get(n1, n2, n3);
-
+            triangles.Value(i).Get(n1, n2, n3);
+            
             // Adjust indices based on node offset and array lower bound
-            std::array<int, 3> nodeIds = {
-                nodeOffset + n1 - nodes.Lower(),
-                nodeOffset + n2 - nodes.Lower(),
-                nodeOffset + n3 - nodes.Lower()
-            };
+            *tri++ = base + n1;
+            *tri++ = base + n2;
+            *tri++ = base + n3;
+            *faceIds++ = sliceFaceId;
+        }
+    });
+}
 
-            auto meshElement = std::make_unique<MeshElement>(nodeIds, elementId++, faceId);
-            boundaryFace->elementIds.push_back(meshElement->id);
-            m_elements.push_back(std::move(meshElement));
+bool BoundaryMesh::loadCachedTriangulation(std::uint64_t shapeHash) {
+    std::shared_ptr<const TriangulationCache::MeshData> data =
+        TriangulationCache::instance().tryGet({shapeHash, m_meshSize, kAngularDeflection});
+    if (!data) return false;
+    
+    std::vector<TopoDS_Face> shapeFaces;
+    for (TopExp_Explorer faceExp(m_shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
+        shapeFaces.push_back(TopoDS::Face(faceExp.Current()));
+    }
+    if (shapeFaces.size() != data->triangulations.size()) {
+        return false;
+    }
+    
+    // Re-attach the triangulations so the shape looks as if it had been meshed
+    BRep_Builder builder;
+    for (size_t i = 0; i < shapeFaces.size(); i++) {
+        if (!data->triangulations[i].IsNull()) {
+            builder.UpdateFace(shapeFaces[i], data->triangulations[i]);
         }
-        
+    }
+    
+    m_nodes = data->nodes;
+    m_elements.resize(data->faceIds.size());
+    std::copy(data->triangles.begin(), data->triangles.end(), m_elements.triangles.begin());
+    std::copy(data->faceIds.begin(), data->faceIds.end(), m_elements.faceIds.begin());
+    
+    for (const auto& range : data->faces) {
+        auto boundaryFace = std::make_unique<BoundaryFace>(shapeFaces[range.faceId], range.faceId,
+                                                          "Face_" + std::to_string(range.faceId));
+        boundaryFace->elements = {range.firstElement, range.elementCount};
         m_faces.push_back(std::move(boundaryFace));
-        // Update node offset with the number of nodes we processed
-        nodeOffset += nodes.Upper() - nodes.Lower() + 1;
     }
+    
+    std::cout << "Reusing cached triangulation (" << m_faces.size() << " faces)" << std::endl;
+    return true;
+}
+
+void BoundaryMesh::storeCachedTriangulation(std::uint64_t shapeHash) const {
+    auto data = std::make_shared<TriangulationCache::MeshData>();
+    
+    for (TopExp_Explorer faceExp(m_shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
+        TopLoc_Location location;
+        data->triangulations.push_back(BRep_Tool::Triangulation(TopoDS::Face(faceExp.Current()), location));
+    }
+    
+    data->nodes = m_nodes;
+    data->triangles = m_elements.triangles;
+    data->faceIds = m_elements.faceIds;
+    data->faces.reserve(m_faces.size());
+    for (const auto& face : m_faces) {
+        data->faces.push_back({face->id, face->elements.first, face->elements.count});
+    }
+    
+    TriangulationCache::instance().put({shapeHash, m_meshSize, kAngularDeflection}, std::move(data));
+}
+
+size_t BoundaryMesh::weldCoincidentNodes(double tolerance) {
+    const size_t nodeCount = m_nodes.size();
+    const size_t elementCount = m_elements.size();
+    
+    SpatialHashGrid::WeldResult weld = SpatialHashGrid::weldPoints(
+        m_nodes.x.data(), m_nodes.y.data(), m_nodes.z.data(), nodeCount, tolerance);
+    const size_t weldedCount = weld.representatives.size();
+    
+    // Gather representative coordinates
+    MeshNodeArrays weldedNodes;
+    weldedNodes.resize(weldedCount);
+    parallelForChunks(weldedCount, 16384, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            const std::int32_t src = weld.representatives[k];
+            weldedNodes.x[k] = m_nodes.x[src];
+            weldedNodes.y[k] = m_nodes.y[src];
+            weldedNodes.z[k] = m_nodes.z[src];
+        }
+    });
+    
+    // Remap triangles and flag the ones that collapsed
+    std::vector<std::int32_t> remapped(m_elements.triangles.size());
+    std::vector<char> keep(elementCount);
+    parallelForChunks(elementCount, 16384, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++) {
+            const std::int32_t a = weld.remap[m_elements.triangles[3 * e]];
+            const std::int32_t b = weld.remap[m_elements.triangles[3 * e + 1]];
+            const std::int32_t c = weld.remap[m_elements.triangles[3 * e + 2]];
+            remapped[3 * e] = a;
+            remapped[3 * e + 1] = b;
+            remapped[3 * e + 2] = c;
+            keep[e] = (a != b && b != c && c != a) ? 1 : 0;
+        }
+    });
+    
+    // Compact elements in order, so each face's elements stay contiguous
+    std::vector<std::int32_t> elementRemap(elementCount, -1);
+    size_t keptCount = 0;
+    for (size_t e = 0; e < elementCount; e++) {
+        if (keep[e]) {
+            elementRemap[e] = static_cast<std::int32_t>(keptCount++);
+        }
+    }
+    
+    MeshElementArrays weldedElements;
+    weldedElements.resize(keptCount);
+    for (size_t e = 0; e < elementCount; e++) {
+        const std::int32_t dst = elementRemap[e];
+        if (dst < 0) continue;
+        weldedElements.triangles[3 * dst] = remapped[3 * e];
+        weldedElements.triangles[3 * dst + 1] = remapped[3 * e + 1];
+        weldedElements.triangles[3 * dst + 2] = remapped[3 * e + 2];
+        weldedElements.faceIds[dst] = m_elements.faceIds[e];
+        weldedElements.areas[dst] = m_elements.areas[e];
+        weldedElements.centroidX[dst] = m_elements.centroidX[e];
+        weldedElements.centroidY[dst] = m_elements.centroidY[e];
+        weldedElements.centroidZ[dst] = m_elements.centroidZ[e];
+    }
+    
+    // Compaction preserves order, so each face's elements stay contiguous
+    for (auto& face : m_faces) {
+        std::int32_t first = static_cast<std::int32_t>(keptCount);
+        std::int32_t count = 0;
+        for (std::int32_t e = face->elements.first; e < face->elements.end(); e++) {
+            if (elementRemap[e] >= 0) {
+                if (count == 0) first = elementRemap[e];
+                count++;
+            }
+        }
+        face->elements = {first, count};
+    }
+    
+    m_nodes = std::move(weldedNodes);
+    m_elements = std::move(weldedElements);
+    m_nodeElements.clear();
+    m_nodeNeighbors.clear();
+    invalidateCompatibilityView();
+    
+    return nodeCount - weldedCount;
+}
+
+size_t BoundaryMesh::weldNodes(double tolerance) {
+    const size_t elementsBefore = m_elements.size();
+    size_t merged = weldCoincidentNodes(tolerance);
+    
+    calculateElementProperties();
+    buildConnectivity();
+    analyzeMeshQuality();
+    
+    std::cout << "Welded boundary mesh: merged " << merged << " nodes, removed "
+              << (elementsBefore - m_elements.size()) << " degenerate elements" << std::endl;
+    return merged;
 }
 
 void BoundaryMesh::calculateElementProperties() {
-    for (auto& element : m_elements) {
-        if (element->nodeIds.size() != 3) continue;
-        
+    const double* x = m_nodes.x.data();
+    const double* y = m_nodes.y.data();
+    const double* z = m_nodes.z.data();
+    const std::int32_t* tri = m_elements.triangles.data();
+    const size_t elementCount = m_elements.size();
+    
+    for (size_t e = 0; e < elementCount; e++) {
         // Get the three vertices of the triangle
-        const gp_Pnt& p1 = m_nodes[element->nodeIds[0]]->point;
-        const gp_Pnt& p2 = m_nodes[element->nodeIds[1]]->point;
-        const gp_Pnt& p3 = m_nodes[element->nodeIds[2]]->point;
+        const std::int32_t n1 = tri[3 * e];
+        const std::int32_t n2 = tri[3 * e + 1];
+        const std::int32_t n3 = tri[3 * e + 2];
         
         // Calculate centroid
-        element->centroid = gp_Pnt(
-            (p1.X() + p2.X() + p3.X()) / 3.0,
-            (p1.Y() + p2.Y() + p3.Y()) / 3.0,
-            (p1.Z() + p2.Z() + p3.Z()) / 3.0
-        );
+        m_elements.centroidX[e] = (x[n1] + x[n2] + x[n3]) / 3.0;
+        m_elements.centroidY[e] = (y[n1] + y[n2] + y[n3]) / 3.0;
+        m_elements.centroidZ[e] = (z[n1] + z[n2] + z[n3]) / 3.0;
         
         // Calculate area using cross product
-        gp_Vec v1(p1, p2);
-        gp_Vec v2(p1, p3);
-        gp_Vec normal = v1.Crossed(v2);
-        element->area = 0.5 * normal.Magnitude();
+        const double v1x = x[n2] - x[n1], v1y = y[n2] - y[n1], v1z = z[n2] - z[n1];
+        const double v2x = x[n3] - x[n1], v2y = y[n3] - y[n1], v2z = z[n3] - z[n1];
+        const double nx = v1y * v2z - v1z * v2y;
+        const double ny = v1z * v2x - v1x * v2z;
+        const double nz = v1x * v2y - v1y * v2x;
+        m_elements.areas[e] = 0.5 * std::sqrt(nx * nx + ny * ny + nz * nz);
     }
+    
+    invalidateCompatibilityView();
+    invalidateSpatialIndex();
+    invalidateQualityCache();
 }
 
 void BoundaryMesh::buildConnectivity() {
-    // Build node-to-element connectivity
-    for (const auto& element : m_elements) {
-        for (int nodeId : element->nodeIds) {
-            if (nodeId < static_cast<int>(m_nodes.size())) {
-                m_nodes[nodeId]->elementIds.push_back(element->id);
+    const size_t nodeCount = m_nodes.size();
+    const size_t elementCount = m_elements.size();
+    const std::int32_t* tri = m_elements.triangles.data();
+    
+    // Node-to-element: counting pass, prefix sum, then scatter
+    std::vector<std::atomic<std::int32_t>> counts(nodeCount);
+    parallelForChunks(nodeCount, 65536, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) counts[i].store(0, std::memory_order_relaxed);
+    });
+    parallelForChunks(elementCount, 16384, [&](size_t begin, size_t end) {
+        for (size_t k = 3 * begin; k < 3 * end; k++) {
+            if (tri[k] >= 0 && tri[k] < static_cast<std::int32_t>(nodeCount)) {
+                counts[tri[k]].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+    
+    m_nodeElements.offsets.assign(nodeCount + 1, 0);
+    for (size_t i = 0; i < nodeCount; i++) {
+        m_nodeElements.offsets[i + 1] = m_nodeElements.offsets[i] + counts[i].load(std::memory_order_relaxed);
+        counts[i].store(m_nodeElements.offsets[i], std::memory_order_relaxed);
+    }
+    
+    m_nodeElements.indices.assign(m_nodeElements.offsets[nodeCount], 0);
+    parallelForChunks(elementCount, 16384, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++) {
+            for (int k = 0; k < 3; k++) {
+                const std::int32_t nodeId = tri[3 * e + k];
+                if (nodeId >= 0 && nodeId < static_cast<std::int32_t>(nodeCount)) {
+                    const std::int32_t slot = counts[nodeId].fetch_add(1, std::memory_order_relaxed);
+                    m_nodeElements.indices[slot] = static_cast<std::int32_t>(e);
+                }
             }
         }
+    });
+    
+    // Scatter order depends on scheduling; sort rows so the result is deterministic
+    parallelForChunks(nodeCount, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            std::sort(m_nodeElements.indices.begin() + m_nodeElements.offsets[i],
+                      m_nodeElements.indices.begin() + m_nodeElements.offsets[i + 1]);
+        }
+    });
+    
+    // Node-to-node: collect the other vertices of incident elements, deduplicated.
+    // The first pass only measures each row so the second can write in place.
+    auto gatherNeighbors = [&](size_t i, std::vector<std::int32_t>& scratch) {
+        scratch.clear();
+        for (const std::int32_t* e = m_nodeElements.begin(i); e != m_nodeElements.end(i); ++e) {
+            for (int k = 0; k < 3; k++) {
+                const std::int32_t nodeId = tri[3 * (*e) + k];
+                if (nodeId != static_cast<std::int32_t>(i)) scratch.push_back(nodeId);
+            }
+        }
+        std::sort(scratch.begin(), scratch.end());
+        scratch.erase(std::unique(scratch.begin(), scratch.end()), scratch.end());
+    };
+    
+    m_nodeNeighbors.offsets.assign(nodeCount + 1, 0);
+    parallelForChunks(nodeCount, 4096, [&](size_t begin, size_t end) {
+        std::vector<std::int32_t> scratch;
+        for (size_t i = begin; i < end; i++) {
+            gatherNeighbors(i, scratch);
+            m_nodeNeighbors.offsets[i + 1] = static_cast<std::int32_t>(scratch.size());
+        }
+    });
+    for (size_t i = 0; i < nodeCount; i++) {
+        m_nodeNeighbors.offsets[i + 1] += m_nodeNeighbors.offsets[i];
     }
+    
+    m_nodeNeighbors.indices.assign(m_nodeNeighbors.offsets[nodeCount], 0);
+    parallelForChunks(nodeCount, 4096, [&](size_t begin, size_t end) {
+        std::vector<std::int32_t> scratch;
+        for (size_t i = begin; i < end; i++) {
+            gatherNeighbors(i, scratch);
+            std::copy(scratch.begin(), scratch.end(),
+                      m_nodeNeighbors.indices.begin() + m_nodeNeighbors.offsets[i]);
+        }
+    });
+    
+    buildFaceRanges();
+    invalidateCompatibilityView();
 }
 
-double BoundaryMesh::calculateElementQuality(const MeshElement& element) const {
-    if (element.nodeIds.size() != 3) return 0.0;
+void BoundaryMesh::buildFaceRanges() {
+    const size_t faceCount = m_faces.size();
+    
+    int maxFaceId = -1;
+    for (const auto& face : m_faces) {
+        maxFaceId = std::max(maxFaceId, face->id);
+    }
+    m_faceIndexById.assign(maxFaceId + 1, -1);
+    for (size_t f = 0; f < faceCount; f++) {
+        m_faceIndexById[m_faces[f]->id] = static_cast<std::int32_t>(f);
+    }
     
-    const gp_Pnt& p1 = m_nodes[element.nodeIds[0]]->point;
-    const gp_Pnt& p2 = m_nodes[element.nodeIds[1]]->point;
-    const gp_Pnt& p3 = m_nodes[element.nodeIds[2]]->point;
+    // Face -> node rows: the sorted distinct nodes of each face's elements
+    std::vector<std::vector<std::int32_t>> rows(faceCount);
+    OSD_Parallel::For(0, static_cast<int>(faceCount), [&](int f) {
+        const IndexRange range = m_faces[f]->elements;
+        std::vector<std::int32_t>& row = rows[f];
+        row.assign(m_elements.triangles.begin() + 3 * static_cast<size_t>(range.first),
+                   m_elements.triangles.begin() + 3 * static_cast<size_t>(range.end()));
+        std::sort(row.begin(), row.end());
+        row.erase(std::unique(row.begin(), row.end()), row.end());
+    });
+    
+    m_faceNodes.offsets.assign(faceCount + 1, 0);
+    for (size_t f = 0; f < faceCount; f++) {
+        m_faceNodes.offsets[f + 1] = m_faceNodes.offsets[f] + static_cast<std::int32_t>(rows[f].size());
+    }
+    m_faceNodes.indices.resize(m_faceNodes.offsets[faceCount]);
+    for (size_t f = 0; f < faceCount; f++) {
+        std::copy(rows[f].begin(), rows[f].end(), m_faceNodes.indices.begin() + m_faceNodes.offsets[f]);
+    }
+}
+
+void BoundaryMesh::invalidateCompatibilityView() {
+    std::lock_guard<std::mutex> lock(m_viewMutex);
+    m_viewValid = false;
+    m_nodeView.clear();
+    m_elementView.clear();
+}
+
+void BoundaryMesh::ensureCompatibilityView() const {
+    std::lock_guard<std::mutex> lock(m_viewMutex);
+    if (m_viewValid) return;
+    
+    const size_t nodeCount = m_nodes.size();
+    const size_t elementCount = m_elements.size();
+    const bool hasConnectivity = m_nodeElements.rowCount() == nodeCount;
+    
+    m_nodeView.clear();
+    m_nodeView.reserve(nodeCount);
+    for (size_t i = 0; i < nodeCount; i++) {
+        auto node = std::make_unique<MeshNode>(m_nodes.point(i), static_cast<int>(i));
+        if (hasConnectivity) {
+            node->elementIds.assign(m_nodeElements.begin(i), m_nodeElements.end(i));
+        }
+        m_nodeView.push_back(std::move(node));
+    }
+    
+    m_elementView.clear();
+    m_elementView.reserve(elementCount);
+    for (size_t e = 0; e < elementCount; e++) {
+        const std::int32_t* tri = m_elements.nodes(e);
+        auto element = std::make_unique<MeshElement>(std::array<int, 3>{tri[0], tri[1], tri[2]},
+                                                     static_cast<int>(e), m_elements.faceIds[e]);
+        element->centroid = m_elements.centroid(e);
+        element->area = m_elements.areas[e];
+        m_elementView.push_back(std::move(element));
+    }
+    
+    m_viewValid = true;
+}
+
+const std::vector<std::unique_ptr<MeshNode>>& BoundaryMesh::getNodes() const {
+    ensureCompatibilityView();
+    return m_nodeView;
+}
+
+const std::vector<std::unique_ptr<MeshElement>>& BoundaryMesh::getElements() const {
+    ensureCompatibilityView();
+    return m_elementView;
+}
+
+double BoundaryMesh::calculateTriangleQuality(int n1, int n2, int n3, double area) const {
+    const gp_Pnt p1 = m_nodes.point(n1);
+    const gp_Pnt p2 = m_nodes.point(n2);
+    const gp_Pnt p3 = m_nodes.point(n3);
     
     // Calculate side lengths
     double a = p1.Distance(p2);
@@ -178,26 +571,39 @@ double BoundaryMesh::calculateElementQuality(const MeshElement& element) const {
     double perimeter = a + b + c;
     if (perimeter < 1e-12) return 0.0;
     
-    double area = element.area;
     double quality = 4.0 * sqrt(3.0) * area / (perimeter * perimeter);
     
     return std::max(0.0, std::min(1.0, quality));
 }
 
-double BoundaryMesh::calculateTriangleAngle(const gp_Pnt& p1, const gp_Pnt& p2, const gp_Pnt& p3) const {
-    gp_Vec v1(p2, p1);
-    gp_Vec v2(p2, p3);
-    
-    double dot = v1.Dot(v2);
-    double mag1 = v1.Magnitude();
-    double mag2 = v2.Magnitude();
-    
-    if (mag1 < 1e-12 || mag2 < 1e-12) return 0.0;
-    
-    double cosAngle = dot / (mag1 * mag2);
-    cosAngle = std::max(-1.0, std::min(1.0, cosAngle));
+double BoundaryMesh::calculateElementQuality(const MeshElement& element) const {
+    if (element.nodeIds.size() != 3) return 0.0;
     
-    return acos(cosAngle);
+    return calculateTriangleQuality(element.nodeIds[0], element.nodeIds[1], element.nodeIds[2], element.area);
+}
+
+double BoundaryMesh::calculateElementQuality(size_t elementIndex) const {
+    return getElementQualityArrays().quality[elementIndex];
+}
+
+const TriangleQualityArrays& BoundaryMesh::getElementQualityArrays() const {
+    std::lock_guard<std::mutex> lock(m_qualityMutex);
+    if (!m_qualityValid) {
+        const size_t elementCount = m_elements.size();
+        m_quality.resize(elementCount);
+        parallelForChunks(elementCount, 16384, [&](size_t begin, size_t end) {
+            MeshQualityKernel::compute(m_nodes.x.data(), m_nodes.y.data(), m_nodes.z.data(),
+                                       m_elements.triangles.data(), begin, end, m_quality);
+        });
+        m_qualityValid = true;
+    }
+    return m_quality;
+}
+
+void BoundaryMesh::invalidateQualityCache() {
+    std::lock_guard<std::mutex> lock(m_qualityMutex);
+    m_qualityValid = false;
+    m_quality.clear();
 }
 
 void BoundaryMesh::regenerate(double newMeshSize) {
@@ -208,16 +614,128 @@ void BoundaryMesh::regenerate(double newMeshSize) {
 }
 
 void BoundaryMesh::refine(const std::vector<gp_Pnt>& refinementPoints, double localSize) {
-    // This is a simplified implementation
-    // In a full implementation, you would use more sophisticated adaptive refinement
     std::cout << "Refining mesh around " << refinementPoints.size() 
               << " points with local size " << localSize << std::endl;
     
-    // For now, just regenerate with smaller mesh size
-    double oldMeshSize = m_meshSize;
-    m_meshSize = std::min(m_meshSize, localSize);
-    generate();
-    m_meshSize = oldMeshSize;
+    if (refinementPoints.empty() || !(localSize > 0.0)) {
+        return;
+    }
+    
+    // Without an existing mesh there is nothing to localize against
+    if (m_elements.empty()) {
+        double oldMeshSize = m_meshSize;
+        m_meshSize = std::min(m_meshSize, localSize);
+        generate();
+        m_meshSize = oldMeshSize;
+        return;
+    }
+    
+    // Faces owning the element closest to each refinement point
+    std::vector<int> closestElements;
+    findClosestElements(refinementPoints, closestElements);
+    std::set<int> targetFaces;
+    for (int e : closestElements) {
+        if (e >= 0) targetFaces.insert(m_elements.faceIds[e]);
+    }
+    refineFaces(targetFaces, localSize);
+}
+
+void BoundaryMesh::refineFaces(const std::set<int>& targetFaces, double localSize) {
+    try {
+        // Faces in explorer order (the order faceIds refer to), their index
+        // in the map of distinct faces, and the faces bounding each edge
+        TopTools_IndexedMapOfShape faceMap;
+        TopExp::MapShapes(m_shape, TopAbs_FACE, faceMap);
+        std::vector<TopoDS_Face> faces;
+        std::vector<std::vector<int>> faceIdsOfMapIndex(faceMap.Extent() + 1);
+        for (TopExp_Explorer faceExp(m_shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
+            faceIdsOfMapIndex[faceMap.FindIndex(faceExp.Current())].push_back(static_cast<int>(faces.size()));
+            faces.push_back(TopoDS::Face(faceExp.Current()));
+        }
+        TopTools_IndexedDataMapOfShapeListOfShape edgeFaces;
+        TopExp::MapShapesAndAncestors(m_shape, TopAbs_EDGE, TopAbs_FACE, edgeFaces);
+        
+        // Target faces that are still coarser than localSize
+        std::set<int> refineFaces;
+        for (int faceId : targetFaces) {
+            if (faceId < 0 || faceId >= static_cast<int>(faces.size())) continue;
+            TopLoc_Location location;
+            Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(faces[faceId], location);
+            if (!triangulation.IsNull() && triangulation->Deflection() <= localSize) {
+                continue;
+            }
+            refineFaces.insert(faceId);
+        }
+        
+        // Ring of untargeted faces sharing an edge with a refined face. Their
+        // shared edges are re-split at localSize, so they are remeshed too,
+        // at the regular size, to stay conforming.
+        std::set<int> ringFaces;
+        for (int faceId : refineFaces) {
+            for (TopExp_Explorer edgeExp(faces[faceId], TopAbs_EDGE); edgeExp.More(); edgeExp.Next()) {
+                const TopTools_ListOfShape& owners = edgeFaces.FindFromKey(edgeExp.Current());
+                for (TopTools_ListIteratorOfListOfShape it(owners); it.More(); it.Next()) {
+                    for (int neighbour : faceIdsOfMapIndex[faceMap.FindIndex(it.Value())]) {
+                        if (refineFaces.count(neighbour) == 0) ringFaces.insert(neighbour);
+                    }
+                }
+            }
+        }
+        
+        std::cout << "Remeshing " << refineFaces.size() << " of " << m_faces.size()
+                  << " faces (plus " << ringFaces.size() << " neighbours)" << std::endl;
+        if (refineFaces.empty()) {
+            return;
+        }
+        
+        // Drop the old triangulations. UpdateFace changes the face's TShape in
+        // place, and that TShape may be shared with other BoundaryMesh
+        // instances over the same geometry (a layer mesh and the global device
+        // mesh); they keep their extracted arrays but see the new
+        // triangulation the next time they extract.
+        BRep_Builder builder;
+        TopoDS_Compound targetCompound, ringCompound;
+        builder.MakeCompound(targetCompound);
+        builder.MakeCompound(ringCompound);
+        for (int faceId : refineFaces) {
+            builder.UpdateFace(faces[faceId], Handle(Poly_Triangulation)());
+            builder.Add(targetCompound, faces[faceId]);
+        }
+        for (int faceId : ringFaces) {
+            builder.UpdateFace(faces[faceId], Handle(Poly_Triangulation)());
+            builder.Add(ringCompound, faces[faceId]);
+        }
+        
+        // Targets first, at localSize. The ring is meshed afterwards at the
+        // regular size: BRepMesh reuses the edge polygons already present on
+        // the neighbouring triangulations (fine towards the targets, the
+        // original ones towards untouched faces), so every seam is split the
+        // same way on both sides and no hanging nodes appear.
+        BRepMesh_IncrementalMesh meshAlgo(targetCompound, localSize, Standard_False, kAngularDeflection, Standard_True);
+        meshAlgo.Perform();
+        if (!meshAlgo.IsDone()) {
+            throw std::runtime_error("Failed to remesh refinement faces");
+        }
+        if (!ringFaces.empty()) {
+            BRepMesh_IncrementalMesh ringAlgo(ringCompound, m_meshSize, Standard_False, kAngularDeflection, Standard_True);
+            ringAlgo.Perform();
+            if (!ringAlgo.IsDone()) {
+                throw std::runtime_error("Failed to remesh faces around the refinement region");
+            }
+        }
+        
+        // Untouched faces keep their triangulation, so only extraction is repeated for them
+        clearMeshData();
+        extractMeshData();
+        assembleMesh();
+        
+        std::cout << "Refined boundary mesh: " << getNodeCount() 
+                  << " nodes, " << getElementCount() << " elements" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Error refining boundary mesh: " << e.what() << std::endl;
+        throw;
+    }
 }
 
 void BoundaryMesh::adaptiveMeshRefinement(double qualityThreshold) {
@@ -238,30 +756,42 @@ void BoundaryMesh::adaptiveMeshRefinement(double qualityThreshold) {
 }
 
 void BoundaryMesh::refineAroundPoints(const std::vector<gp_Pnt>& points, double radius, double localSize) {
-    std::vector<gp_Pnt> refinementPoints;
+    if (points.empty() || !(localSize > 0.0)) {
+        return;
+    }
+    if (m_elements.empty()) {
+        refine(points, localSize);
+        return;
+    }
     
+    // Faces with any triangle reaching into a sphere; the tree only visits
+    // elements near the spheres, so the cost follows the refined area
+    const MeshBVH& tree = getElementTree();
+    const double radius2 = radius * radius;
+    std::set<int> targetFaces;
+    double scratch[3];
     for (const auto& point : points) {
-        // Find all elements within radius
-        for (const auto& element : m_elements) {
-            double distance = element->centroid.Distance(point);
-            if (distance <= radius) {
-                refinementPoints.push_back(element->centroid);
-            }
-        }
+        const double p[3] = {point.X(), point.Y(), point.Z()};
+        tree.forEachWithin(p[0], p[1], p[2], radius2, [&](std::int32_t e) {
+            return elementDistance2(e, p, scratch);
+        }, [&](std::int32_t e) {
+            targetFaces.insert(m_elements.faceIds[e]);
+        });
     }
     
-    if (!refinementPoints.empty()) {
-        refine(refinementPoints, localSize);
-    }
+    std::cout << "Refining " << targetFaces.size() << " faces within " << radius
+              << " of " << points.size() << " points with local size " << localSize << std::endl;
+    refineFaces(targetFaces, localSize);
 }
 
 void BoundaryMesh::refineInterface(const BoundaryMesh& otherMesh, double interfaceSize) {
     // Find interface elements between this mesh and another mesh
-    std::vector<MeshElement*> interfaceElements = findInterfaceElements(otherMesh, interfaceSize);
+    const std::vector<InterfacePair> interfacePairs = matchInterfaceElements(otherMesh, interfaceSize);
     
     std::vector<gp_Pnt> refinementPoints;
-    for (const auto* element : interfaceElements) {
-        refinementPoints.push_back(element->centroid);
+    refinementPoints.reserve(interfacePairs.size());
+    for (const auto& pair : interfacePairs) {
+        refinementPoints.push_back(m_elements.centroid(pair.index));
     }
     
     if (!refinementPoints.empty()) {
@@ -269,51 +799,173 @@ void BoundaryMesh::refineInterface(const BoundaryMesh& otherMesh, double interfa
     }
 }
 
-MeshNode* BoundaryMesh::findClosestNode(const gp_Pnt& point) const {
-    MeshNode* closest = nullptr;
-    double minDistance = std::numeric_limits<double>::max();
-    
-    for (const auto& node : m_nodes) {
-        double distance = node->point.Distance(point);
-        if (distance < minDistance) {
-            minDistance = distance;
-            closest = node.get();
-        }
+const MeshBVH& BoundaryMesh::getElementTree() const {
+    std::lock_guard<std::mutex> lock(m_treeMutex);
+    if (!m_elementTree) {
+        const size_t elementCount = m_elements.size();
+        std::vector<double> boxes(6 * elementCount);
+        parallelForChunks(elementCount, 16384, [&](size_t begin, size_t end) {
+            for (size_t e = begin; e < end; e++) {
+                const std::int32_t* tri = m_elements.nodes(e);
+                const double xs[3] = {m_nodes.x[tri[0]], m_nodes.x[tri[1]], m_nodes.x[tri[2]]};
+                const double ys[3] = {m_nodes.y[tri[0]], m_nodes.y[tri[1]], m_nodes.y[tri[2]]};
+                const double zs[3] = {m_nodes.z[tri[0]], m_nodes.z[tri[1]], m_nodes.z[tri[2]]};
+                double* box = &boxes[6 * e];
+                box[0] = std::min({xs[0], xs[1], xs[2]});
+                box[1] = std::min({ys[0], ys[1], ys[2]});
+                box[2] = std::min({zs[0], zs[1], zs[2]});
+                box[3] = std::max({xs[0], xs[1], xs[2]});
+                box[4] = std::max({ys[0], ys[1], ys[2]});
+                box[5] = std::max({zs[0], zs[1], zs[2]});
+            }
+        });
+        std::unique_ptr<MeshBVH> tree(new MeshBVH());
+        tree->build(boxes.data(), elementCount);
+        m_elementTree = std::move(tree);
     }
+    return *m_elementTree;
+}
+
+const MeshBVH& BoundaryMesh::getNodeTree() const {
+    std::lock_guard<std::mutex> lock(m_treeMutex);
+    if (!m_nodeTree) {
+        const size_t nodeCount = m_nodes.size();
+        std::vector<double> boxes(6 * nodeCount);
+        parallelForChunks(nodeCount, 16384, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                double* box = &boxes[6 * i];
+                box[0] = box[3] = m_nodes.x[i];
+                box[1] = box[4] = m_nodes.y[i];
+                box[2] = box[5] = m_nodes.z[i];
+            }
+        });
+        std::unique_ptr<MeshBVH> tree(new MeshBVH());
+        tree->build(boxes.data(), nodeCount);
+        m_nodeTree = std::move(tree);
+    }
+    return *m_nodeTree;
+}
+
+void BoundaryMesh::invalidateSpatialIndex() {
+    std::lock_guard<std::mutex> lock(m_treeMutex);
+    m_elementTree.reset();
+    m_nodeTree.reset();
+}
+
+double BoundaryMesh::elementDistance2(size_t elementIndex, const double* p, double* closest) const {
+    const std::int32_t* tri = m_elements.nodes(elementIndex);
+    const double a[3] = {m_nodes.x[tri[0]], m_nodes.y[tri[0]], m_nodes.z[tri[0]]};
+    const double b[3] = {m_nodes.x[tri[1]], m_nodes.y[tri[1]], m_nodes.z[tri[1]]};
+    const double c[3] = {m_nodes.x[tri[2]], m_nodes.y[tri[2]], m_nodes.z[tri[2]]};
+    return MeshBVH::closestPointOnTriangle(p, a, b, c, closest);
+}
+
+int BoundaryMesh::findClosestNodeIndex(const gp_Pnt& point) const {
+    const MeshBVH& tree = getNodeTree();
+    const double px = point.X(), py = point.Y(), pz = point.Z();
+    double bestDistance2 = std::numeric_limits<double>::max();
+    return tree.nearest(px, py, pz, [&](std::int32_t i) {
+        const double dx = m_nodes.x[i] - px, dy = m_nodes.y[i] - py, dz = m_nodes.z[i] - pz;
+        return dx * dx + dy * dy + dz * dz;
+    }, bestDistance2);
+}
+
+int BoundaryMesh::findClosestElementIndex(const gp_Pnt& point, gp_Pnt* closestPoint, double* distance) const {
+    const MeshBVH& tree = getElementTree();
+    const double p[3] = {point.X(), point.Y(), point.Z()};
+    double scratch[3];
+    double bestDistance2 = std::numeric_limits<double>::max();
+    const std::int32_t best = tree.nearest(p[0], p[1], p[2], [&](std::int32_t e) {
+        return elementDistance2(e, p, scratch);
+    }, bestDistance2);
     
-    return closest;
+    if (best >= 0) {
+        double closest[3];
+        elementDistance2(best, p, closest);
+        if (closestPoint) *closestPoint = gp_Pnt(closest[0], closest[1], closest[2]);
+        if (distance) *distance = std::sqrt(bestDistance2);
+    }
+    return best;
 }
 
-MeshElement* BoundaryMesh::findElementContaining(const gp_Pnt& point) const {
-    // Simplified point-in-triangle test
-    // In a full implementation, you would use more efficient spatial data structures
+MeshNode* BoundaryMesh::findClosestNode(const gp_Pnt& point) const {
+    const int closest = findClosestNodeIndex(point);
+    if (closest < 0) return nullptr;
+    return getNodes()[closest].get();
+}
+
+MeshElement* BoundaryMesh::findElementContaining(const gp_Pnt& point, double tolerance) const {
+    // A surface mesh has no interior, so "containing" means the point lies on
+    // the triangle to within tolerance
+    double distance = 0.0;
+    const int closest = findClosestElementIndex(point, nullptr, &distance);
+    if (closest < 0 || distance > tolerance) return nullptr;
+    return getElements()[closest].get();
+}
+
+void BoundaryMesh::findClosestNodes(const std::vector<gp_Pnt>& points, std::vector<int>& nodeIds) const {
+    nodeIds.assign(points.size(), -1);
+    if (m_nodes.empty()) return;
     
-    for (const auto& element : m_elements) {
-        if (element->nodeIds.size() != 3) continue;
-        
-        const gp_Pnt& p1 = m_nodes[element->nodeIds[0]]->point;
-        const gp_Pnt& p2 = m_nodes[element->nodeIds[1]]->point;
-        const gp_Pnt& p3 = m_nodes[element->nodeIds[2]]->point;
-        
-        // Simple distance-based check - point is "in" triangle if close to centroid
-        double distance = point.Distance(element->centroid);
-        double avgEdgeLength = (p1.Distance(p2) + p2.Distance(p3) + p3.Distance(p1)) / 3.0;
-        
-        if (distance < avgEdgeLength * 0.5) {
-            return element.get();
+    const MeshBVH& tree = getNodeTree();
+    parallelForChunks(points.size(), 1024, [&](size_t begin, size_t end) {
+        for (size_t q = begin; q < end; q++) {
+            const double px = points[q].X(), py = points[q].Y(), pz = points[q].Z();
+            double bestDistance2 = std::numeric_limits<double>::max();
+            nodeIds[q] = tree.nearest(px, py, pz, [&](std::int32_t i) {
+                const double dx = m_nodes.x[i] - px, dy = m_nodes.y[i] - py, dz = m_nodes.z[i] - pz;
+                return dx * dx + dy * dy + dz * dz;
+            }, bestDistance2);
         }
-    }
+    });
+}
+
+void BoundaryMesh::findClosestElements(const std::vector<gp_Pnt>& points, std::vector<int>& elementIds,
+                                       std::vector<double>* distances) const {
+    elementIds.assign(points.size(), -1);
+    if (distances) distances->assign(points.size(), std::numeric_limits<double>::max());
+    if (m_elements.empty()) return;
     
-    return nullptr;
+    const MeshBVH& tree = getElementTree();
+    parallelForChunks(points.size(), 1024, [&](size_t begin, size_t end) {
+        double scratch[3];
+        for (size_t q = begin; q < end; q++) {
+            const double p[3] = {points[q].X(), points[q].Y(), points[q].Z()};
+            double bestDistance2 = std::numeric_limits<double>::max();
+            elementIds[q] = tree.nearest(p[0], p[1], p[2], [&](std::int32_t e) {
+                return elementDistance2(e, p, scratch);
+            }, bestDistance2);
+            if (distances && elementIds[q] >= 0) (*distances)[q] = std::sqrt(bestDistance2);
+        }
+    });
+}
+
+const BoundaryFace* BoundaryMesh::getFace(int faceId) const {
+    if (faceId < 0 || faceId >= static_cast<int>(m_faceIndexById.size())) return nullptr;
+    const std::int32_t index = m_faceIndexById[faceId];
+    return index < 0 ? nullptr : m_faces[index].get();
+}
+
+IndexRange BoundaryMesh::getFaceElementRange(int faceId) const {
+    const BoundaryFace* face = getFace(faceId);
+    return face ? face->elements : IndexRange();
+}
+
+IndexSpan BoundaryMesh::getFaceNodeIndices(int faceId) const {
+    if (!getFace(faceId) || m_faceNodes.rowCount() != m_faces.size()) return IndexSpan();
+    const std::int32_t index = m_faceIndexById[faceId];
+    return {m_faceNodes.begin(index), static_cast<size_t>(m_faceNodes.degree(index))};
 }
 
 std::vector<MeshElement*> BoundaryMesh::getElementsOnFace(int faceId) const {
     std::vector<MeshElement*> result;
+    const IndexRange range = getFaceElementRange(faceId);
+    if (range.empty()) return result;
     
-    for (const auto& element : m_elements) {
-        if (element->faceId == faceId) {
-            result.push_back(element.get());
-        }
+    const auto& elements = getElements();
+    result.reserve(range.size());
+    for (std::int32_t e = range.first; e < range.end(); e++) {
+        result.push_back(elements[e].get());
     }
     
     return result;
@@ -321,17 +973,13 @@ std::vector<MeshElement*> BoundaryMesh::getElementsOnFace(int faceId) const {
 
 std::vector<MeshNode*> BoundaryMesh::getNodesOnFace(int faceId) const {
     std::vector<MeshNode*> result;
-    std::set<int> addedNodes;
-    
-    for (const auto& element : m_elements) {
-        if (element->faceId == faceId) {
-            for (int nodeId : element->nodeIds) {
-                if (addedNodes.find(nodeId) == addedNodes.end()) {
-                    result.push_back(m_nodes[nodeId].get());
-                    addedNodes.insert(nodeId);
-                }
-            }
-        }
+    const IndexSpan nodeIndices = getFaceNodeIndices(faceId);
+    if (nodeIndices.empty()) return result;
+    
+    const auto& nodes = getNodes();
+    result.reserve(nodeIndices.size());
+    for (std::int32_t nodeId : nodeIndices) {
+        result.push_back(nodes[nodeId].get());
     }
     
     return result;
@@ -345,38 +993,32 @@ void BoundaryMesh::analyzeMeshQuality() {
         return;
     }
     
-    double totalQuality = 0.0;
-    m_minAngle = M_PI;
-    m_maxAngle = 0.0;
+    const TriangleQualityArrays& quality = getElementQualityArrays();
     
-    for (const auto& element : m_elements) {
-        double quality = calculateElementQuality(*element);
-        totalQuality += quality;
-        
-        if (element->nodeIds.size() == 3) {
-            const gp_Pnt& p1 = m_nodes[element->nodeIds[0]]->point;
-            const gp_Pnt& p2 = m_nodes[element->nodeIds[1]]->point;
-            const gp_Pnt& p3 = m_nodes[element->nodeIds[2]]->point;
-            
-            double angle1 = calculateTriangleAngle(p1, p2, p3);
-            double angle2 = calculateTriangleAngle(p2, p3, p1);
-            double angle3 = calculateTriangleAngle(p3, p1, p2);
-            
-            m_minAngle = std::min({m_minAngle, angle1, angle2, angle3});
-            m_maxAngle = std::max({m_maxAngle, angle1, angle2, angle3});
-        }
+    // Reduce in element order so the average does not depend on threading;
+    // angles are tracked as cosines and converted once at the end
+    double totalQuality = 0.0;
+    double cosMinAngle = -1.0;
+    double cosMaxAngle = 1.0;
+    for (size_t e = 0; e < quality.size(); e++) {
+        totalQuality += quality.quality[e];
+        cosMinAngle = std::max(cosMinAngle, quality.cosMinAngle[e]);
+        cosMaxAngle = std::min(cosMaxAngle, quality.cosMaxAngle[e]);
     }
     
+    m_minAngle = std::acos(cosMinAngle);
+    m_maxAngle = std::acos(cosMaxAngle);
     m_avgElementQuality = totalQuality / m_elements.size();
 }
 
 std::vector<MeshElement*> BoundaryMesh::getLowQualityElements(double threshold) const {
     std::vector<MeshElement*> result;
+    const auto& elements = getElements();
+    const std::vector<double>& quality = getElementQualityArrays().quality;
     
-    for (const auto& element : m_elements) {
-        double quality = calculateElementQuality(*element);
-        if (quality < threshold) {
-            result.push_back(element.get());
+    for (size_t e = 0; e < m_elements.size(); e++) {
+        if (quality[e] < threshold) {
+            result.push_back(elements[e].get());
         }
     }
     
@@ -391,8 +1033,8 @@ double BoundaryMesh::calculateMeshVolume() const {
 double BoundaryMesh::calculateMeshSurfaceArea() const {
     double totalArea = 0.0;
     
-    for (const auto& element : m_elements) {
-        totalArea += element->area;
+    for (double area : m_elements.areas) {
+        totalArea += area;
     }
     
     return totalArea;
@@ -400,108 +1042,228 @@ double BoundaryMesh::calculateMeshSurfaceArea() const {
 
 
 
-void BoundaryMesh::exportToSTL(const std::string& filename) const {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file for writing: " + filename);
+namespace {
+// Unit normal of a triangle from its winding; zero for degenerate triangles
+void facetNormal(const MeshNodeArrays& nodes, const std::int32_t* tri, double normal[3]) {
+    const double ux = nodes.x[tri[1]] - nodes.x[tri[0]];
+    const double uy = nodes.y[tri[1]] - nodes.y[tri[0]];
+    const double uz = nodes.z[tri[1]] - nodes.z[tri[0]];
+    const double vx = nodes.x[tri[2]] - nodes.x[tri[0]];
+    const double vy = nodes.y[tri[2]] - nodes.y[tri[0]];
+    const double vz = nodes.z[tri[2]] - nodes.z[tri[0]];
+    normal[0] = uy * vz - uz * vy;
+    normal[1] = uz * vx - ux * vz;
+    normal[2] = ux * vy - uy * vx;
+    const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    for (int k = 0; k < 3; k++) {
+        normal[k] = length > 0.0 ? normal[k] / length : 0.0;
     }
-    
-    file << "solid BoundaryMesh" << std::endl;
-    
-    for (const auto& element : m_elements) {
-        if (element->nodeIds.size() != 3) continue;
+}
+} // namespace
+
+void BoundaryMesh::exportToSTL(const std::string& filename, bool binary) const {
+    OutputSink file(filename);
+    exportToSTL(file, binary);
+    file.close();
+    std::cout << "Exported mesh to " << (binary ? "binary " : "") << "STL file: " << filename << std::endl;
+}
+
+void BoundaryMesh::exportToSTL(OutputSink& file, bool binary) const {
+    if (binary) {
+        // 80-byte header, triangle count, then 50-byte little-endian records
+        char header[80] = {};
+        std::strncpy(header, "BoundaryMesh binary STL", sizeof(header));
+        file.write(header, sizeof(header));
+        file.writeLittleEndian(static_cast<std::uint32_t>(m_elements.size()));
         
-        const gp_Pnt& p1 = m_nodes[element->nodeIds[0]]->point;
-        const gp_Pnt& p2 = m_nodes[element->nodeIds[1]]->point;
-        const gp_Pnt& p3 = m_nodes[element->nodeIds[2]]->point;
+        for (size_t e = 0; e < m_elements.size(); e++) {
+            const std::int32_t* tri = m_elements.nodes(e);
+            double normal[3];
+            facetNormal(m_nodes, tri, normal);
+            
+            float record[12];
+            for (int k = 0; k < 3; k++) {
+                record[k] = static_cast<float>(normal[k]);
+            }
+            for (int v = 0; v < 3; v++) {
+                record[3 + 3 * v] = static_cast<float>(m_nodes.x[tri[v]]);
+                record[4 + 3 * v] = static_cast<float>(m_nodes.y[tri[v]]);
+                record[5 + 3 * v] = static_cast<float>(m_nodes.z[tri[v]]);
+            }
+            for (float value : record) {
+                file.writeLittleEndian(value);
+            }
+            file.writeLittleEndian(static_cast<std::uint16_t>(0));
+        }
         
-        // Calculate normal
-        gp_Vec v1(p1, p2);
-        gp_Vec v2(p1, p3);
-        gp_Vec normal = v1.Crossed(v2);
-        normal.Normalize();
+        file.flush();
+        return;
+    }
+    
+    file << "solid BoundaryMesh\n";
+    
+    for (size_t e = 0; e < m_elements.size(); e++) {
+        const std::int32_t* tri = m_elements.nodes(e);
+        double normal[3];
+        facetNormal(m_nodes, tri, normal);
         
-        file << "facet normal " << normal.X() << " " << normal.Y() << " " << normal.Z() << std::endl;
-        file << "outer loop" << std::endl;
-        file << "vertex " << p1.X() << " " << p1.Y() << " " << p1.Z() << std::endl;
-        file << "vertex " << p2.X() << " " << p2.Y() << " " << p2.Z() << std::endl;
-        file << "vertex " << p3.X() << " " << p3.Y() << " " << p3.Z() << std::endl;
-        file << "endloop" << std::endl;
-        file << "endfacet" << std::endl;
+        file << "facet normal " << normal[0] << ' ' << normal[1] << ' ' << normal[2] << '\n';
+        file << "outer loop\n";
+        for (int v = 0; v < 3; v++) {
+            file << "vertex " << m_nodes.x[tri[v]] << ' ' << m_nodes.y[tri[v]] << ' ' << m_nodes.z[tri[v]] << '\n';
+        }
+        file << "endloop\n";
+        file << "endfacet\n";
     }
     
-    file << "endsolid BoundaryMesh" << std::endl;
-    file.close();
-    std::cout << "Exported mesh to STL file: " << filename << std::endl;
+    file << "endsolid BoundaryMesh\n";
+    file.flush();
 }
 
 void BoundaryMesh::exportToGMSH(const std::string& filename) const {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file for writing: " + filename);
-    }
-    
+    OutputSink file(filename);
+    exportToGMSH(file);
+    file.close();
+    std::cout << "Exported mesh to GMSH file: " << filename << std::endl;
+}
+
+void BoundaryMesh::exportToGMSH(OutputSink& file) const {
     // GMSH format
-    file << "$MeshFormat" << std::endl;
-    file << "2.2 0 8" << std::endl;
-    file << "$EndMeshFormat" << std::endl;
+    file << "$MeshFormat\n";
+    file << "2.2 0 8\n";
+    file << "$EndMeshFormat\n";
     
     // Nodes
-    file << "$Nodes" << std::endl;
-    file << m_nodes.size() << std::endl;
-    for (const auto& node : m_nodes) {
-        file << (node->id + 1) << " " << node->point.X() << " " 
-             << node->point.Y() << " " << node->point.Z() << std::endl;
+    file << "$Nodes\n";
+    file << m_nodes.size() << '\n';
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+        file << (i + 1) << ' ' << m_nodes.x[i] << ' ' 
+             << m_nodes.y[i] << ' ' << m_nodes.z[i] << '\n';
     }
-    file << "$EndNodes" << std::endl;
+    file << "$EndNodes\n";
     
     // Elements
-    file << "$Elements" << std::endl;
-    file << m_elements.size() << std::endl;
-    for (const auto& element : m_elements) {
-        file << (element->id + 1) << " 2 2 0 " << (element->faceId + 1) << " "
-             << (element->nodeIds[0] + 1) << " " << (element->nodeIds[1] + 1) 
-             << " " << (element->nodeIds[2] + 1) << std::endl;
+    file << "$Elements\n";
+    file << m_elements.size() << '\n';
+    for (size_t e = 0; e < m_elements.size(); e++) {
+        const std::int32_t* tri = m_elements.nodes(e);
+        file << (e + 1) << " 2 2 0 " << (m_elements.faceIds[e] + 1) << ' '
+             << (tri[0] + 1) << ' ' << (tri[1] + 1) 
+             << ' ' << (tri[2] + 1) << '\n';
     }
-    file << "$EndElements" << std::endl;
-    
-    file.close();
-    std::cout << "Exported mesh to GMSH file: " << filename << std::endl;
+    file << "$EndElements\n";
+    file.flush();
 }
 
 void BoundaryMesh::exportToOBJ(const std::string& filename) const {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file for writing: " + filename);
-    }
-    
+    OutputSink file(filename);
+    exportToOBJ(file);
+    file.close();
+    std::cout << "Exported mesh to OBJ file: " << filename << std::endl;
+}
+
+void BoundaryMesh::exportToOBJ(OutputSink& file) const {
     // Vertices
-    for (const auto& node : m_nodes) {
-        file << "v " << node->point.X() << " " << node->point.Y() << " " << node->point.Z() << std::endl;
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+        file << "v " << m_nodes.x[i] << ' ' << m_nodes.y[i] << ' ' << m_nodes.z[i] << '\n';
     }
     
     // Faces
-    for (const auto& element : m_elements) {
-        if (element->nodeIds.size() == 3) {
-            file << "f " << (element->nodeIds[0] + 1) << " " 
-                 << (element->nodeIds[1] + 1) << " " << (element->nodeIds[2] + 1) << std::endl;
+    for (size_t e = 0; e < m_elements.size(); e++) {
+        const std::int32_t* tri = m_elements.nodes(e);
+        file << "f " << (tri[0] + 1) << ' ' 
+             << (tri[1] + 1) << ' ' << (tri[2] + 1) << '\n';
+    }
+    file.flush();
+}
+
+void BoundaryMesh::adoptImportedMesh(ImportedMesh& mesh) {
+    const size_t elementCount = mesh.faceIds.size();
+    
+    // Faces own contiguous element runs: if the file interleaves faces,
+    // reorder elements with a stable counting sort on the face id
+    if (!std::is_sorted(mesh.faceIds.begin(), mesh.faceIds.end())) {
+        const std::int32_t maxFaceId = *std::max_element(mesh.faceIds.begin(), mesh.faceIds.end());
+        std::vector<std::int32_t> next(maxFaceId + 2, 0);
+        for (std::int32_t faceId : mesh.faceIds) {
+            next[faceId + 1]++;
+        }
+        for (std::int32_t f = 0; f <= maxFaceId; f++) {
+            next[f + 1] += next[f];
         }
+        std::vector<std::int32_t> triangles(mesh.triangles.size());
+        std::vector<std::int32_t> faceIds(elementCount);
+        for (size_t e = 0; e < elementCount; e++) {
+            const std::int32_t dst = next[mesh.faceIds[e]]++;
+            std::copy(mesh.triangles.begin() + 3 * e, mesh.triangles.begin() + 3 * e + 3,
+                      triangles.begin() + 3 * static_cast<size_t>(dst));
+            faceIds[dst] = mesh.faceIds[e];
+        }
+        mesh.triangles.swap(triangles);
+        mesh.faceIds.swap(faceIds);
     }
     
-    file.close();
-    std::cout << "Exported mesh to OBJ file: " << filename << std::endl;
+    clearMeshData();
+    m_nodes = std::move(mesh.nodes);
+    m_elements.resize(elementCount);
+    m_elements.triangles = std::move(mesh.triangles);
+    m_elements.faceIds = std::move(mesh.faceIds);
+    
+    std::vector<TopoDS_Face> shapeFaces;
+    if (!m_shape.IsNull()) {
+        for (TopExp_Explorer faceExp(m_shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
+            shapeFaces.push_back(TopoDS::Face(faceExp.Current()));
+        }
+    }
+    
+    for (size_t first = 0; first < elementCount;) {
+        const std::int32_t faceId = m_elements.faceIds[first];
+        size_t last = first;
+        while (last < elementCount && m_elements.faceIds[last] == faceId) last++;
+        
+        const TopoDS_Face face = static_cast<size_t>(faceId) < shapeFaces.size() ? shapeFaces[faceId] : TopoDS_Face();
+        auto boundaryFace = std::make_unique<BoundaryFace>(face, faceId, "Face_" + std::to_string(faceId));
+        boundaryFace->elements = {static_cast<std::int32_t>(first), static_cast<std::int32_t>(last - first)};
+        m_faces.push_back(std::move(boundaryFace));
+        first = last;
+    }
 }
 
 bool BoundaryMesh::importFromVTK(const std::string& filename) {
-    // Placeholder implementation
-    std::cout << "VTK import not implemented yet: " << filename << std::endl;
-    return false;
+    try {
+        ImportedMesh mesh = MeshFileReader::readVTK(filename);
+        const size_t skipped = mesh.skippedCells;
+        adoptImportedMesh(mesh);
+        assembleMesh();
+        
+        std::cout << "Imported VTK file " << filename << ": " << getNodeCount() << " nodes, "
+                  << getElementCount() << " elements, " << getFaceCount() << " faces" << std::endl;
+        if (skipped > 0) {
+            std::cout << "  Skipped " << skipped << " non-surface cells" << std::endl;
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error importing VTK file: " << e.what() << std::endl;
+        return false;
+    }
 }
 
-bool BoundaryMesh::importFromSTL(const std::string& filename) {
-    // Placeholder implementation
-    std::cout << "STL import not implemented yet: " << filename << std::endl;
-    return false;
+bool BoundaryMesh::importFromSTL(const std::string& filename, double weldTolerance) {
+    try {
+        ImportedMesh mesh = MeshFileReader::readSTL(filename);
+        adoptImportedMesh(mesh);
+        if (weldTolerance > 0.0) {
+            weldCoincidentNodes(weldTolerance);
+        }
+        assembleMesh();
+        
+        std::cout << "Imported STL file " << filename << ": " << getNodeCount() << " nodes, "
+                  << getElementCount() << " elements" << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error importing STL file: " << e.what() << std::endl;
+        return false;
+    }
 }
 
 void BoundaryMesh::printMeshStatistics() const {
@@ -530,17 +1292,12 @@ std::pair<gp_Pnt, gp_Pnt> BoundaryMesh::getBoundingBox() const {
         return {gp_Pnt(0,0,0), gp_Pnt(0,0,0)};
     }
     
-    const gp_Pnt& firstPoint = m_nodes[0]->point;
-    double minX = firstPoint.X(), maxX = firstPoint.X();
-    double minY = firstPoint.Y(), maxY = firstPoint.Y();
-    double minZ = firstPoint.Z(), maxZ = firstPoint.Z();
-    
-    for (const auto& node : m_nodes) {
-        const gp_Pnt& p = node->point;
-        minX = std::min(minX, p.X()); maxX = std::max(maxX, p.X());
-        minY = std::min(minY, p.Y()); maxY = std::max(maxY, p.Y());
-        minZ = std::min(minZ, p.Z()); maxZ = std::max(maxZ, p.Z());
-    }
+    auto xRange = std::minmax_element(m_nodes.x.begin(), m_nodes.x.end());
+    auto yRange = std::minmax_element(m_nodes.y.begin(), m_nodes.y.end());
+    auto zRange = std::minmax_element(m_nodes.z.begin(), m_nodes.z.end());
+    double minX = *xRange.first, maxX = *xRange.second;
+    double minY = *yRange.first, maxY = *yRange.second;
+    double minZ = *zRange.first, maxZ = *zRange.second;
     
     return {gp_Pnt(minX, minY, minZ), gp_Pnt(maxX, maxY, maxZ)};
 }
@@ -551,11 +1308,9 @@ bool BoundaryMesh::validateMesh() const {
     }
     
     // Check if all element node indices are valid
-    for (const auto& element : m_elements) {
-        for (int nodeId : element->nodeIds) {
-            if (nodeId < 0 || nodeId >= static_cast<int>(m_nodes.size())) {
-                return false;
-            }
+    for (std::int32_t nodeId : m_elements.triangles) {
+        if (nodeId < 0 || nodeId >= static_cast<std::int32_t>(m_nodes.size())) {
+            return false;
         }
     }
     
@@ -564,9 +1319,12 @@ bool BoundaryMesh::validateMesh() const {
 
 bool BoundaryMesh::checkMeshConnectivity() const {
     // Simplified connectivity check
-    for (const auto& node : m_nodes) {
-        if (node->elementIds.empty()) {
-            std::cerr << "Warning: Orphaned node found (ID: " << node->id << ")" << std::endl;
+    if (m_nodeElements.rowCount() != m_nodes.size()) {
+        return m_nodes.empty();
+    }
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+        if (m_nodeElements.degree(i) == 0) {
+            std::cerr << "Warning: Orphaned node found (ID: " << i << ")" << std::endl;
             return false;
         }
     }
@@ -575,10 +1333,11 @@ bool BoundaryMesh::checkMeshConnectivity() const {
 }
 
 bool BoundaryMesh::checkElementQuality(double minQuality) const {
-    for (const auto& element : m_elements) {
-        double quality = calculateElementQuality(*element);
+    const std::vector<double>& qualities = getElementQualityArrays().quality;
+    for (size_t e = 0; e < m_elements.size(); e++) {
+        double quality = qualities[e];
         if (quality < minQuality) {
-            std::cerr << "Warning: Low quality element found (ID: " << element->id 
+            std::cerr << "Warning: Low quality element found (ID: " << e 
                       << ", Quality: " << quality << ")" << std::endl;
             return false;
         }
@@ -587,77 +1346,762 @@ bool BoundaryMesh::checkElementQuality(double minQuality) const {
     return true;
 }
 
+namespace {
+
+enum class SmoothingNodeKind : std::uint8_t { Free, Sliding, Locked };
+
+// Per-node smoothing constraints, derived once from the connectivity
+struct SmoothingConstraints {
+    std::vector<SmoothingNodeKind> kind;
+    std::vector<std::int32_t> seamNeighbors;  // Two entries per node, used by sliding nodes
+    std::vector<std::int32_t> nodeFace;       // Owning face id of free nodes
+};
+
+// Projects points onto the surface of one TopoDS_Face
+struct FaceProjector {
+    bool valid = false;
+    bool planar = false;
+    gp_Pnt origin;
+    gp_Dir normal;
+    Handle(Geom_Surface) surface;
+    
+    void project(double& x, double& y, double& z) const {
+        if (!valid) return;
+        if (planar) {
+            const double d = (x - origin.X()) * normal.X() + (y - origin.Y()) * normal.Y()
+                           + (z - origin.Z()) * normal.Z();
+            x -= d * normal.X();
+            y -= d * normal.Y();
+            z -= d * normal.Z();
+            return;
+        }
+        GeomAPI_ProjectPointOnSurf projection(gp_Pnt(x, y, z), surface);
+        if (projection.NbPoints() > 0) {
+            const gp_Pnt nearest = projection.NearestPoint();
+            x = nearest.X();
+            y = nearest.Y();
+            z = nearest.Z();
+        }
+    }
+};
+
+// Projectors indexed by face id
+std::vector<FaceProjector> buildFaceProjectors(const std::vector<std::unique_ptr<BoundaryFace>>& faces) {
+    std::vector<FaceProjector> projectors;
+    for (const auto& face : faces) {
+        if (face->id >= static_cast<int>(projectors.size())) projectors.resize(face->id + 1);
+        FaceProjector& projector = projectors[face->id];
+        if (face->face.IsNull()) continue;  // imported faces may have no geometry
+        projector.surface = BRep_Tool::Surface(face->face);
+        if (projector.surface.IsNull()) continue;
+        projector.valid = true;
+        GeomAdaptor_Surface adaptor(projector.surface);
+        if (adaptor.GetType() == GeomAbs_Plane) {
+            const gp_Pln plane = adaptor.Plane();
+            projector.planar = true;
+            projector.origin = plane.Location();
+            projector.normal = plane.Axis().Direction();
+        }
+    }
+    return projectors;
+}
+
+// An edge (i, j) is interior to a face when exactly two triangles of that
+// face share it; every other edge lies on a seam or sharp feature
+bool isInteriorEdge(const MeshAdjacency& nodeElements, const std::vector<std::int32_t>& faceIds,
+                    std::int32_t i, std::int32_t j) {
+    std::int32_t shared[3];
+    int sharedCount = 0;
+    const std::int32_t* a = nodeElements.begin(i);
+    const std::int32_t* b = nodeElements.begin(j);
+    while (a != nodeElements.end(i) && b != nodeElements.end(j)) {
+        if (*a < *b) ++a;
+        else if (*b < *a) ++b;
+        else {
+            if (sharedCount == 2) return false;
+            shared[sharedCount++] = *a;
+            ++a;
+            ++b;
+        }
+    }
+    return sharedCount == 2 && faceIds[shared[0]] == faceIds[shared[1]];
+}
+
+SmoothingConstraints classifySmoothingNodes(const MeshNodeArrays& nodes, const MeshElementArrays& elements,
+                                            const MeshAdjacency& nodeElements, const MeshAdjacency& nodeNeighbors,
+                                            const SmoothingOptions& options) {
+    const size_t nodeCount = nodes.size();
+    SmoothingConstraints constraints;
+    constraints.kind.assign(nodeCount, SmoothingNodeKind::Locked);
+    constraints.seamNeighbors.assign(2 * nodeCount, -1);
+    constraints.nodeFace.assign(nodeCount, -1);
+    
+    parallelForChunks(nodeCount, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (nodeElements.degree(i) == 0) continue;
+            
+            std::int32_t face = elements.faceIds[*nodeElements.begin(i)];
+            bool multiFace = false;
+            for (const std::int32_t* e = nodeElements.begin(i); e != nodeElements.end(i); ++e) {
+                if (elements.faceIds[*e] != face) multiFace = true;
+            }
+            
+            int seamCount = 0;
+            std::int32_t seam[2] = {-1, -1};
+            for (const std::int32_t* j = nodeNeighbors.begin(i); j != nodeNeighbors.end(i); ++j) {
+                if (!isInteriorEdge(nodeElements, elements.faceIds, static_cast<std::int32_t>(i), *j)) {
+                    if (seamCount < 2) seam[seamCount] = *j;
+                    seamCount++;
+                }
+            }
+            
+            if (seamCount == 0 && !multiFace) {
+                constraints.kind[i] = SmoothingNodeKind::Free;
+                constraints.nodeFace[i] = face;
+                continue;
+            }
+            if (seamCount != 2 || !options.slideAlongSeams) continue;
+            
+            // Slide only where the seam is locally straight, so corners and
+            // curved edges keep their shape
+            const double ax = nodes.x[i] - nodes.x[seam[0]], ay = nodes.y[i] - nodes.y[seam[0]], az = nodes.z[i] - nodes.z[seam[0]];
+            const double bx = nodes.x[seam[1]] - nodes.x[i], by = nodes.y[seam[1]] - nodes.y[i], bz = nodes.z[seam[1]] - nodes.z[i];
+            const double cx = ay * bz - az * by, cy = az * bx - ax * bz, cz = ax * by - ay * bx;
+            const double lengthA = std::sqrt(ax * ax + ay * ay + az * az);
+            const double lengthB = std::sqrt(bx * bx + by * by + bz * bz);
+            const double sine = std::sqrt(cx * cx + cy * cy + cz * cz);
+            const double dot = ax * bx + ay * by + az * bz;
+            if (dot > 0.0 && sine <= options.seamCollinearity * lengthA * lengthB) {
+                constraints.kind[i] = SmoothingNodeKind::Sliding;
+                constraints.seamNeighbors[2 * i] = seam[0];
+                constraints.seamNeighbors[2 * i + 1] = seam[1];
+            }
+        }
+    });
+    
+    return constraints;
+}
+
+// Average quality and minimum quality of the current node positions
+std::pair<double, double> measureQuality(const MeshNodeArrays& nodes, const MeshElementArrays& elements,
+                                         TriangleQualityArrays& scratch) {
+    const size_t elementCount = elements.size();
+    scratch.resize(elementCount);
+    parallelForChunks(elementCount, 16384, [&](size_t begin, size_t end) {
+        MeshQualityKernel::compute(nodes.x.data(), nodes.y.data(), nodes.z.data(),
+                                   elements.triangles.data(), begin, end, scratch);
+    });
+    
+    double total = 0.0;
+    double minimum = elementCount > 0 ? 1.0 : 0.0;
+    for (double q : scratch.quality) {
+        total += q;
+        minimum = std::min(minimum, q);
+    }
+    return {elementCount > 0 ? total / elementCount : 0.0, minimum};
+}
+
+} // namespace
+
 void BoundaryMesh::smoothMesh(int iterations) {
     std::cout << "Smoothing mesh with " << iterations << " iterations..." << std::endl;
     
-    for (int iter = 0; iter < iterations; iter++) {
-        laplacianSmoothing();
+    SmoothingOptions options;
+    options.maxIterations = iterations;
+    smoothMesh(options);
+}
+
+SmoothingReport BoundaryMesh::smoothMesh(const SmoothingOptions& options) {
+    SmoothingReport report;
+    const size_t nodeCount = m_nodes.size();
+    if (nodeCount == 0 || m_elements.empty()) return report;
+    
+    if (m_nodeNeighbors.rowCount() != nodeCount) {
+        buildConnectivity();
+    }
+    
+    const SmoothingConstraints constraints =
+        classifySmoothingNodes(m_nodes, m_elements, m_nodeElements, m_nodeNeighbors, options);
+    for (SmoothingNodeKind kind : constraints.kind) {
+        if (kind == SmoothingNodeKind::Free) report.freeNodes++;
+        else if (kind == SmoothingNodeKind::Sliding) report.slidingNodes++;
+        else report.lockedNodes++;
+    }
+    
+    // Surface projectors for the faces free nodes belong to
+    std::vector<FaceProjector> projectors;
+    if (options.projectToSurface) {
+        projectors = buildFaceProjectors(m_faces);
     }
     
+    TriangleQualityArrays scratch;
+    std::pair<double, double> quality = measureQuality(m_nodes, m_elements, scratch);
+    report.averageQuality.push_back(quality.first);
+    report.minimumQuality.push_back(quality.second);
+    
+    MeshNodeArrays next;
+    next.resize(nodeCount);
+    const double lambda = options.relaxation;
+    
+    for (int iter = 0; iter < options.maxIterations; iter++) {
+        // Jacobi update: every node reads only the previous positions
+        parallelForChunks(nodeCount, 4096, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                double x = m_nodes.x[i], y = m_nodes.y[i], z = m_nodes.z[i];
+                
+                if (constraints.kind[i] == SmoothingNodeKind::Free) {
+                    double sumX = 0.0, sumY = 0.0, sumZ = 0.0;
+                    for (const std::int32_t* n = m_nodeNeighbors.begin(i); n != m_nodeNeighbors.end(i); ++n) {
+                        sumX += m_nodes.x[*n];
+                        sumY += m_nodes.y[*n];
+                        sumZ += m_nodes.z[*n];
+                    }
+                    const double inverseCount = 1.0 / m_nodeNeighbors.degree(i);
+                    x += lambda * (sumX * inverseCount - x);
+                    y += lambda * (sumY * inverseCount - y);
+                    z += lambda * (sumZ * inverseCount - z);
+                    
+                    const std::int32_t face = constraints.nodeFace[i];
+                    if (face >= 0 && face < static_cast<std::int32_t>(projectors.size())) {
+                        projectors[face].project(x, y, z);
+                    }
+                } else if (constraints.kind[i] == SmoothingNodeKind::Sliding) {
+                    // The seam neighbours are collinear with the node, so
+                    // their midpoint keeps it on the seam
+                    const std::int32_t a = constraints.seamNeighbors[2 * i];
+                    const std::int32_t b = constraints.seamNeighbors[2 * i + 1];
+                    x += lambda * (0.5 * (m_nodes.x[a] + m_nodes.x[b]) - x);
+                    y += lambda * (0.5 * (m_nodes.y[a] + m_nodes.y[b]) - y);
+                    z += lambda * (0.5 * (m_nodes.z[a] + m_nodes.z[b]) - z);
+                }
+                
+                next.x[i] = x;
+                next.y[i] = y;
+                next.z[i] = z;
+            }
+        });
+        
+        const std::pair<double, double> nextQuality = measureQuality(next, m_elements, scratch);
+        if (nextQuality.first < quality.first) {
+            // The iteration made things worse; keep the previous positions
+            report.stoppedEarly = true;
+            break;
+        }
+        
+        std::swap(m_nodes, next);
+        report.iterations++;
+        report.averageQuality.push_back(nextQuality.first);
+        report.minimumQuality.push_back(nextQuality.second);
+        
+        const double improvement = nextQuality.first - quality.first;
+        quality = nextQuality;
+        if (improvement < options.minImprovement) {
+            report.stoppedEarly = iter + 1 < options.maxIterations;
+            break;
+        }
+    }
+    
+    std::cout << "Smoothing: " << report.iterations << " iterations, average quality "
+              << report.averageQuality.front() << " -> " << report.averageQuality.back()
+              << " (" << report.freeNodes << " free, " << report.slidingNodes << " sliding, "
+              << report.lockedNodes << " locked nodes)" << std::endl;
+    
     // Recalculate element properties after smoothing
-    calculateElementProperties();
-    analyzeMeshQuality();
+    if (report.iterations > 0) {
+        calculateElementProperties();
+        analyzeMeshQuality();
+    }
+    
+    return report;
 }
 
 void BoundaryMesh::laplacianSmoothing() {
-    // Store new positions
-    std::vector<gp_Pnt> newPositions(m_nodes.size());
+    // Single feature-preserving Jacobi step
+    SmoothingOptions options;
+    options.maxIterations = 1;
+    options.minImprovement = -std::numeric_limits<double>::max();
+    smoothMesh(options);
+}
+
+namespace {
+
+// Shape quality 4*sqrt(3)*area / perimeter^2 of one triangle, as in MeshQualityKernel
+double triangleQuality(const double* p0, const double* p1, const double* p2) {
+    const double ux = p1[0] - p0[0], uy = p1[1] - p0[1], uz = p1[2] - p0[2];
+    const double vx = p2[0] - p0[0], vy = p2[1] - p0[1], vz = p2[2] - p0[2];
+    const double wx = p2[0] - p1[0], wy = p2[1] - p1[1], wz = p2[2] - p1[2];
+    const double perimeter = std::sqrt(ux * ux + uy * uy + uz * uz) + std::sqrt(wx * wx + wy * wy + wz * wz)
+                           + std::sqrt(vx * vx + vy * vy + vz * vz);
+    if (perimeter < 1e-12) return 0.0;
+    const double nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+    const double area = 0.5 * std::sqrt(nx * nx + ny * ny + nz * nz);
+    return std::max(0.0, std::min(1.0, 4.0 * std::sqrt(3.0) * area / (perimeter * perimeter)));
+}
+
+void triangleNormal(const double* p0, const double* p1, const double* p2, double* n) {
+    const double ux = p1[0] - p0[0], uy = p1[1] - p0[1], uz = p1[2] - p0[2];
+    const double vx = p2[0] - p0[0], vy = p2[1] - p0[1], vz = p2[2] - p0[2];
+    n[0] = uy * vz - uz * vy;
+    n[1] = uz * vx - ux * vz;
+    n[2] = ux * vy - uy * vx;
+}
+
+double dot3(const double* a, const double* b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+// Cotangent of the angle at c in triangle (a, b, c)
+double cotangentAt(const double* a, const double* b, const double* c) {
+    const double u[3] = {a[0] - c[0], a[1] - c[1], a[2] - c[2]};
+    const double v[3] = {b[0] - c[0], b[1] - c[1], b[2] - c[2]};
+    const double cross[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+    const double sine = std::sqrt(dot3(cross, cross));
+    return sine > 0.0 ? dot3(u, v) / sine : std::numeric_limits<double>::max();
+}
+
+std::uint64_t edgeKey(std::int32_t a, std::int32_t b) {
+    if (a > b) std::swap(a, b);
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(a)) << 32) | static_cast<std::uint32_t>(b);
+}
+
+// Triangles of one face with edge adjacency. Edge k of triangle t runs from
+// tri[3t + k] to tri[3t + (k + 1) % 3]; neighbor[3t + k] is the triangle on
+// the other side, or -1 on the face boundary and at non-manifold edges.
+// Node ids >= 0 refer to mesh nodes, ids < 0 to inserted node -(id + 1).
+class FaceTriangulation {
+public:
+    std::vector<std::int32_t> tri;
+    std::vector<std::int32_t> neighbor;
+    std::vector<double> newX, newY, newZ;
     
-    for (size_t i = 0; i < m_nodes.size(); i++) {
-        const auto& node = m_nodes[i];
-        gp_Pnt avgPosition(0, 0, 0);
-        int neighborCount = 0;
-        
-        // Find neighboring nodes through shared elements
-        for (int elemId : node->elementIds) {
-            const auto& element = m_elements[elemId];
-            for (int nodeId : element->nodeIds) {
-                if (nodeId != node->id && nodeId < static_cast<int>(m_nodes.size())) {
-                    const gp_Pnt& neighborPos = m_nodes[nodeId]->point;
-                    avgPosition = gp_Pnt(
-                        avgPosition.X() + neighborPos.X(),
-                        avgPosition.Y() + neighborPos.Y(),
-                        avgPosition.Z() + neighborPos.Z()
-                    );
-                    neighborCount++;
+    explicit FaceTriangulation(const MeshNodeArrays& nodes) : m_nodes(nodes) {}
+    
+    size_t triangleCount() const { return tri.size() / 3; }
+    
+    void point(std::int32_t id, double* p) const {
+        if (id >= 0) {
+            p[0] = m_nodes.x[id];
+            p[1] = m_nodes.y[id];
+            p[2] = m_nodes.z[id];
+        } else {
+            p[0] = newX[-id - 1];
+            p[1] = newY[-id - 1];
+            p[2] = newZ[-id - 1];
+        }
+    }
+    
+    double quality(size_t t) const {
+        double p0[3], p1[3], p2[3];
+        point(tri[3 * t], p0);
+        point(tri[3 * t + 1], p1);
+        point(tri[3 * t + 2], p2);
+        return triangleQuality(p0, p1, p2);
+    }
+    
+    void buildAdjacency() {
+        const size_t halfEdgeCount = tri.size();
+        std::vector<std::pair<std::uint64_t, std::int32_t>> halfEdges(halfEdgeCount);
+        for (size_t h = 0; h < halfEdgeCount; h++) {
+            halfEdges[h] = {edgeKey(tri[h], tri[next(h)]), static_cast<std::int32_t>(h)};
+        }
+        std::sort(halfEdges.begin(), halfEdges.end());
+        
+        neighbor.assign(halfEdgeCount, -1);
+        m_edges.clear();
+        for (size_t i = 0; i < halfEdgeCount;) {
+            size_t j = i + 1;
+            while (j < halfEdgeCount && halfEdges[j].first == halfEdges[i].first) j++;
+            m_edges.insert(halfEdges[i].first);
+            if (j - i == 2) {
+                const std::int32_t h0 = halfEdges[i].second, h1 = halfEdges[i + 1].second;
+                neighbor[h0] = h1 / 3;
+                neighbor[h1] = h0 / 3;
+            }
+            i = j;
+        }
+    }
+    
+    // Lawson flipping until no interior edge violates the Delaunay criterion
+    size_t flipToDelaunay(double cosMaxDihedral) {
+        std::vector<std::int32_t> stack;
+        for (size_t h = 0; h < tri.size(); h++) {
+            if (neighbor[h] > static_cast<std::int32_t>(h / 3)) stack.push_back(static_cast<std::int32_t>(h));
+        }
+        
+        // Flips cannot cycle in the plane; the cap guards curved faces
+        const size_t maxFlips = 8 * triangleCount() + 64;
+        size_t flips = 0;
+        while (!stack.empty() && flips < maxFlips) {
+            const std::int32_t h = stack.back();
+            stack.pop_back();
+            if (neighbor[h] < 0 || !shouldFlip(h, cosMaxDihedral)) continue;
+            
+            const std::int32_t t = h / 3;
+            const std::int32_t u = neighbor[h];
+            flip(h);
+            flips++;
+            stack.push_back(3 * t);
+            stack.push_back(3 * t + 2);
+            stack.push_back(3 * u);
+            stack.push_back(3 * u + 1);
+        }
+        return flips;
+    }
+    
+    // Split the longest edge of each poor triangle at its midpoint, projected
+    // onto the face. Only interior edges are split so seams stay conforming.
+    size_t splitPoorTriangles(double threshold, const FaceProjector* projector) {
+        const size_t originalCount = triangleCount();
+        std::vector<char> used(originalCount, 0);
+        size_t splits = 0;
+        
+        for (size_t t = 0; t < originalCount; t++) {
+            if (used[t] || quality(t) >= threshold) continue;
+            
+            // Longest edge of t
+            int longest = 0;
+            double longestLength2 = -1.0;
+            for (int k = 0; k < 3; k++) {
+                double p[3], q[3];
+                point(tri[3 * t + k], p);
+                point(tri[3 * t + (k + 1) % 3], q);
+                const double d[3] = {q[0] - p[0], q[1] - p[1], q[2] - p[2]};
+                if (dot3(d, d) > longestLength2) {
+                    longestLength2 = dot3(d, d);
+                    longest = k;
                 }
             }
+            const size_t h = 3 * t + longest;
+            const std::int32_t u = neighbor[h];
+            if (u < 0 || used[u]) continue;
+            
+            const std::int32_t a = tri[h], b = tri[next(h)], c = tri[next(next(h))];
+            const int j = findHalfEdge(u, b, a);
+            if (j < 0) continue;
+            const std::int32_t d = tri[3 * u + (j + 2) % 3];
+            
+            double pa[3], pb[3];
+            point(a, pa);
+            point(b, pb);
+            double mx = 0.5 * (pa[0] + pb[0]), my = 0.5 * (pa[1] + pb[1]), mz = 0.5 * (pa[2] + pb[2]);
+            if (projector) projector->project(mx, my, mz);
+            newX.push_back(mx);
+            newY.push_back(my);
+            newZ.push_back(mz);
+            const std::int32_t m = -static_cast<std::int32_t>(newX.size());
+            
+            // (a, b, c) + (b, a, d)  ->  (a, m, c) (m, b, c) + (b, m, d) (m, a, d)
+            setTriangle(t, a, m, c);
+            setTriangle(u, b, m, d);
+            tri.insert(tri.end(), {m, b, c, m, a, d});
+            used[t] = used[u] = 1;
+            splits++;
         }
         
-        if (neighborCount > 0) {
-            newPositions[i] = gp_Pnt(
-                avgPosition.X() / neighborCount,
-                avgPosition.Y() / neighborCount,
-                avgPosition.Z() / neighborCount
-            );
-        } else {
-            newPositions[i] = node->point;
+        if (splits > 0) buildAdjacency();
+        return splits;
+    }
+
+private:
+    static size_t next(size_t h) { return h - h % 3 + (h + 1) % 3; }
+    
+    void setTriangle(size_t t, std::int32_t a, std::int32_t b, std::int32_t c) {
+        tri[3 * t] = a;
+        tri[3 * t + 1] = b;
+        tri[3 * t + 2] = c;
+    }
+    
+    // Local edge index k of triangle t with edge (from, to), or -1
+    int findHalfEdge(std::int32_t t, std::int32_t from, std::int32_t to) const {
+        for (int k = 0; k < 3; k++) {
+            if (tri[3 * t + k] == from && tri[3 * t + (k + 1) % 3] == to) return k;
         }
+        return -1;
     }
     
-    // Update node positions
-    for (size_t i = 0; i < m_nodes.size(); i++) {
-        m_nodes[i]->point = newPositions[i];
+    void relink(std::int32_t t, std::int32_t from, std::int32_t to, std::int32_t oldNeighbor, std::int32_t newNeighbor) {
+        if (t < 0) return;
+        for (int k = 0; k < 3; k++) {
+            const std::int32_t p = tri[3 * t + k], q = tri[3 * t + (k + 1) % 3];
+            if (neighbor[3 * t + k] == oldNeighbor && ((p == from && q == to) || (p == to && q == from))) {
+                neighbor[3 * t + k] = newNeighbor;
+                return;
+            }
+        }
+    }
+    
+    bool shouldFlip(std::int32_t h, double cosMaxDihedral) const {
+        const std::int32_t u = neighbor[h];
+        const std::int32_t a = tri[h], b = tri[next(h)], c = tri[next(next(h))];
+        const int j = findHalfEdge(u, b, a);
+        if (j < 0) return false;
+        const std::int32_t d = tri[3 * u + (j + 2) % 3];
+        if (c == d || m_edges.count(edgeKey(c, d))) return false;
+        
+        double pa[3], pb[3], pc[3], pd[3];
+        point(a, pa);
+        point(b, pb);
+        point(c, pc);
+        point(d, pd);
+        
+        // Delaunay criterion: the angles opposite the edge sum to more than pi
+        if (cotangentAt(pa, pb, pc) + cotangentAt(pb, pa, pd) >= -1e-12) return false;
+        
+        // Keep the surface shape: nearly flat hinge, and both new triangles
+        // facing the same way as the old pair
+        double nt[3], nu[3], n1[3], n2[3];
+        triangleNormal(pa, pb, pc, nt);
+        triangleNormal(pb, pa, pd, nu);
+        const double lengthT = std::sqrt(dot3(nt, nt)), lengthU = std::sqrt(dot3(nu, nu));
+        if (lengthT == 0.0 || lengthU == 0.0) return false;
+        if (dot3(nt, nu) < cosMaxDihedral * lengthT * lengthU) return false;
+        
+        const double average[3] = {nt[0] / lengthT + nu[0] / lengthU, nt[1] / lengthT + nu[1] / lengthU,
+                                   nt[2] / lengthT + nu[2] / lengthU};
+        triangleNormal(pa, pd, pc, n1);
+        triangleNormal(pd, pb, pc, n2);
+        return dot3(n1, average) > 0.0 && dot3(n2, average) > 0.0;
+    }
+    
+    void flip(std::int32_t h) {
+        const std::int32_t t = h / 3;
+        const std::int32_t u = neighbor[h];
+        const std::int32_t a = tri[h], b = tri[next(h)], c = tri[next(next(h))];
+        const int j = findHalfEdge(u, b, a);
+        const std::int32_t d = tri[3 * u + (j + 2) % 3];
+        
+        const std::int32_t nbc = neighbor[next(h)];
+        const std::int32_t nca = neighbor[next(next(h))];
+        const std::int32_t nad = neighbor[3 * u + (j + 1) % 3];
+        const std::int32_t ndb = neighbor[3 * u + (j + 2) % 3];
+        
+        // (a, b, c) + (b, a, d)  ->  (a, d, c) + (d, b, c)
+        setTriangle(t, a, d, c);
+        neighbor[3 * t] = nad;
+        neighbor[3 * t + 1] = u;
+        neighbor[3 * t + 2] = nca;
+        setTriangle(u, d, b, c);
+        neighbor[3 * u] = ndb;
+        neighbor[3 * u + 1] = nbc;
+        neighbor[3 * u + 2] = t;
+        relink(nad, a, d, u, t);
+        relink(nbc, b, c, t, u);
+        
+        m_edges.erase(edgeKey(a, b));
+        m_edges.insert(edgeKey(c, d));
+    }
+    
+    const MeshNodeArrays& m_nodes;
+    std::unordered_set<std::uint64_t> m_edges;
+};
+
+std::vector<size_t> qualityHistogram(const std::vector<double>& quality) {
+    std::vector<size_t> bins(DelaunayReport::kHistogramBins, 0);
+    for (double q : quality) {
+        const int bin = std::min(DelaunayReport::kHistogramBins - 1,
+                                 static_cast<int>(q * DelaunayReport::kHistogramBins));
+        bins[std::max(0, bin)]++;
     }
+    return bins;
 }
 
+} // namespace
+
 void BoundaryMesh::delaunayRefinement() {
-    // Placeholder for Delaunay refinement
-    std::cout << "Delaunay refinement not implemented yet" << std::endl;
+    delaunayRefinement(DelaunayOptions());
 }
 
-std::vector<MeshElement*> BoundaryMesh::findInterfaceElements(const BoundaryMesh& otherMesh, double tolerance) const {
-    std::vector<MeshElement*> interfaceElements;
+DelaunayReport BoundaryMesh::delaunayRefinement(const DelaunayOptions& options) {
+    DelaunayReport report;
+    report.histogramBefore = qualityHistogram(getElementQualityArrays().quality);
     
-    for (const auto& element : m_elements) {
-        // Check if element centroid is close to any element in other mesh
-        MeshElement* closestElement = otherMesh.findElementContaining(element->centroid);
-        if (closestElement) {
-            double distance = element->centroid.Distance(closestElement->centroid);
-            if (distance <= tolerance) {
-                interfaceElements.push_back(element.get());
+    const double cosMaxDihedral = std::cos(options.maxDihedralAngle);
+    std::vector<FaceProjector> projectors;
+    if (options.insertSteinerPoints) {
+        projectors = buildFaceProjectors(m_faces);
+    }
+    
+    // Improve every face independently; faces share only boundary edges,
+    // which are never touched
+    const size_t faceCount = m_faces.size();
+    std::vector<std::unique_ptr<FaceTriangulation>> results(faceCount);
+    std::vector<size_t> faceFlips(faceCount, 0), faceSplits(faceCount, 0);
+    OSD_Parallel::For(0, static_cast<int>(faceCount), [&](int f) {
+        const IndexRange range = m_faces[f]->elements;
+        std::unique_ptr<FaceTriangulation> local(new FaceTriangulation(m_nodes));
+        local->tri.assign(m_elements.triangles.begin() + 3 * static_cast<size_t>(range.first),
+                          m_elements.triangles.begin() + 3 * static_cast<size_t>(range.end()));
+        local->buildAdjacency();
+        faceFlips[f] = local->flipToDelaunay(cosMaxDihedral);
+        
+        if (options.insertSteinerPoints) {
+            const int faceId = m_faces[f]->id;
+            const FaceProjector* projector =
+                faceId < static_cast<int>(projectors.size()) ? &projectors[faceId] : nullptr;
+            for (int pass = 0; pass < options.steinerPasses; pass++) {
+                const size_t splits = local->splitPoorTriangles(options.steinerQualityThreshold, projector);
+                if (splits == 0) break;
+                faceSplits[f] += splits;
+                faceFlips[f] += local->flipToDelaunay(cosMaxDihedral);
             }
         }
+        results[f] = std::move(local);
+    });
+    
+    for (size_t f = 0; f < faceCount; f++) {
+        report.flips += faceFlips[f];
+        report.steinerPoints += faceSplits[f];
+    }
+    
+    if (report.flips > 0 || report.steinerPoints > 0) {
+        // Reassemble: inserted nodes are appended face by face, and each face
+        // keeps a contiguous element run in the original face order
+        std::vector<std::int32_t> newNodeBase(faceCount, 0);
+        size_t nodeCount = m_nodes.size();
+        size_t elementCount = 0;
+        for (size_t f = 0; f < faceCount; f++) {
+            newNodeBase[f] = static_cast<std::int32_t>(nodeCount);
+            nodeCount += results[f]->newX.size();
+            elementCount += results[f]->triangleCount();
+        }
+        if (nodeCount > static_cast<size_t>(std::numeric_limits<std::int32_t>::max())) {
+            throw std::runtime_error("Mesh node count exceeds 32-bit index range");
+        }
+        
+        MeshElementArrays elements;
+        elements.resize(elementCount);
+        size_t elementOffset = 0;
+        for (size_t f = 0; f < faceCount; f++) {
+            const FaceTriangulation& local = *results[f];
+            for (size_t k = 0; k < local.newX.size(); k++) {
+                m_nodes.push_back(gp_Pnt(local.newX[k], local.newY[k], local.newZ[k]));
+            }
+            for (size_t k = 0; k < local.tri.size(); k++) {
+                const std::int32_t id = local.tri[k];
+                elements.triangles[3 * elementOffset + k] = id >= 0 ? id : newNodeBase[f] - id - 1;
+            }
+            std::fill(elements.faceIds.begin() + elementOffset,
+                      elements.faceIds.begin() + elementOffset + local.triangleCount(), m_faces[f]->id);
+            m_faces[f]->elements = {static_cast<std::int32_t>(elementOffset),
+                                    static_cast<std::int32_t>(local.triangleCount())};
+            elementOffset += local.triangleCount();
+        }
+        m_elements = std::move(elements);
+        
+        calculateElementProperties();
+        buildConnectivity();
+        analyzeMeshQuality();
+    }
+    
+    report.histogramAfter = qualityHistogram(getElementQualityArrays().quality);
+    
+    std::cout << "Delaunay refinement: " << report.flips << " edge flips, "
+              << report.steinerPoints << " Steiner points" << std::endl;
+    std::cout << "  Quality histogram (before -> after):" << std::endl;
+    for (int bin = 0; bin < DelaunayReport::kHistogramBins; bin++) {
+        std::cout << "    " << bin / 10.0 << "-" << (bin + 1) / 10.0 << ": "
+                  << report.histogramBefore[bin] << " -> " << report.histogramAfter[bin] << std::endl;
+    }
+    
+    return report;
+}
+
+namespace {
+
+// True if the axis-aligned boxes, each grown by tolerance, overlap
+bool boxesOverlap(const std::pair<gp_Pnt, gp_Pnt>& a, const std::pair<gp_Pnt, gp_Pnt>& b, double tolerance) {
+    return a.first.X() <= b.second.X() + tolerance && b.first.X() <= a.second.X() + tolerance &&
+           a.first.Y() <= b.second.Y() + tolerance && b.first.Y() <= a.second.Y() + tolerance &&
+           a.first.Z() <= b.second.Z() + tolerance && b.first.Z() <= a.second.Z() + tolerance;
+}
+
+// Gather the entries with a match, in index order
+std::vector<InterfacePair> compactMatches(const std::vector<std::int32_t>& matches,
+                                          const std::vector<double>& distances) {
+    std::vector<InterfacePair> pairs;
+    for (size_t i = 0; i < matches.size(); i++) {
+        if (matches[i] >= 0) {
+            pairs.push_back({static_cast<std::int32_t>(i), matches[i], distances[i]});
+        }
+    }
+    return pairs;
+}
+
+} // namespace
+
+std::vector<InterfacePair> BoundaryMesh::matchInterfaceElements(const BoundaryMesh& otherMesh, double tolerance) const {
+    if (m_elements.empty() || otherMesh.m_elements.empty() ||
+        !boxesOverlap(getBoundingBox(), otherMesh.getBoundingBox(), tolerance)) {
+        return {};
+    }
+    
+    const MeshBVH& tree = otherMesh.getElementTree();
+    // Searching with the tolerance as the initial bound prunes every subtree
+    // farther away, so elements off the interface cost only a few box tests
+    const double searchRadius2 = std::nextafter(tolerance * tolerance, std::numeric_limits<double>::max());
+    const size_t elementCount = m_elements.size();
+    std::vector<std::int32_t> matches(elementCount);
+    std::vector<double> distances(elementCount);
+    
+    parallelForChunks(elementCount, 1024, [&](size_t begin, size_t end) {
+        double scratch[3];
+        for (size_t e = begin; e < end; e++) {
+            const double p[3] = {m_elements.centroidX[e], m_elements.centroidY[e], m_elements.centroidZ[e]};
+            double bestDistance2 = searchRadius2;
+            matches[e] = tree.nearest(p[0], p[1], p[2], [&](std::int32_t other) {
+                return otherMesh.elementDistance2(other, p, scratch);
+            }, bestDistance2);
+            distances[e] = std::sqrt(bestDistance2);
+        }
+    });
+    
+    return compactMatches(matches, distances);
+}
+
+std::vector<InterfacePair> BoundaryMesh::matchInterfaceNodes(const BoundaryMesh& otherMesh, double tolerance) const {
+    if (m_nodes.empty() || otherMesh.m_nodes.empty() ||
+        !boxesOverlap(getBoundingBox(), otherMesh.getBoundingBox(), tolerance)) {
+        return {};
+    }
+    
+    const MeshBVH& tree = otherMesh.getNodeTree();
+    const MeshNodeArrays& otherNodes = otherMesh.m_nodes;
+    const double searchRadius2 = std::nextafter(tolerance * tolerance, std::numeric_limits<double>::max());
+    const size_t nodeCount = m_nodes.size();
+    std::vector<std::int32_t> matches(nodeCount);
+    std::vector<double> distances(nodeCount);
+    
+    parallelForChunks(nodeCount, 1024, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const double px = m_nodes.x[i], py = m_nodes.y[i], pz = m_nodes.z[i];
+            double bestDistance2 = searchRadius2;
+            matches[i] = tree.nearest(px, py, pz, [&](std::int32_t other) {
+                const double dx = otherNodes.x[other] - px;
+                const double dy = otherNodes.y[other] - py;
+                const double dz = otherNodes.z[other] - pz;
+                return dx * dx + dy * dy + dz * dz;
+            }, bestDistance2);
+            distances[i] = std::sqrt(bestDistance2);
+        }
+    });
+    
+    return compactMatches(matches, distances);
+}
+
+MeshInterface BoundaryMesh::detectInterface(const BoundaryMesh& otherMesh, double tolerance) const {
+    MeshInterface result;
+    result.elementPairs = matchInterfaceElements(otherMesh, tolerance);
+    result.nodePairs = matchInterfaceNodes(otherMesh, tolerance);
+    return result;
+}
+
+std::vector<MeshElement*> BoundaryMesh::findInterfaceElements(const BoundaryMesh& otherMesh, double tolerance) const {
+    std::vector<MeshElement*> interfaceElements;
+    const std::vector<InterfacePair> pairs = matchInterfaceElements(otherMesh, tolerance);
+    if (pairs.empty()) return interfaceElements;
+    
+    const auto& elements = getElements();
+    interfaceElements.reserve(pairs.size());
+    for (const auto& pair : pairs) {
+        interfaceElements.push_back(elements[pair.index].get());
     }
     
     return interfaceElements;
@@ -665,15 +2109,13 @@ std::vector<MeshElement*> BoundaryMesh::findInterfaceElements(const BoundaryMesh
 
 std::vector<MeshNode*> BoundaryMesh::findInterfaceNodes(const BoundaryMesh& otherMesh, double tolerance) const {
     std::vector<MeshNode*> interfaceNodes;
+    const std::vector<InterfacePair> pairs = matchInterfaceNodes(otherMesh, tolerance);
+    if (pairs.empty()) return interfaceNodes;
     
-    for (const auto& node : m_nodes) {
-        MeshNode* closestNode = otherMesh.findClosestNode(node->point);
-        if (closestNode) {
-            double distance = node->point.Distance(closestNode->point);
-            if (distance <= tolerance) {
-                interfaceNodes.push_back(node.get());
-            }
-        }
+    const auto& nodes = getNodes();
+    interfaceNodes.reserve(pairs.size());
+    for (const auto& pair : pairs) {
+        interfaceNodes.push_back(nodes[pair.index].get());
     }
     
     return interfaceNodes;
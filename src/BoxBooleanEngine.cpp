@@ -0,0 +1,684 @@
+// BoxBooleanEngine.cpp
+#include "BoxBooleanEngine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <BRepAdaptor_Surface.hxx>
+#include <BRepBuilderAPI_MakeEdge.hxx>
+#include <BRepBuilderAPI_MakeFace.hxx>
+#include <BRepBuilderAPI_MakeVertex.hxx>
+#include <BRepLib.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <NCollection_DataMap.hxx>
+#include <ShapeUpgrade_UnifySameDomain.hxx>
+#include <Standard_Failure.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopTools_ShapeMapHasher.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Shell.hxx>
+#include <TopoDS_Solid.hxx>
+#include <TopoDS_Wire.hxx>
+#include <gp_Pln.hxx>
+
+namespace {
+
+const size_t kMaxCells = size_t(1) << 22;     // Grid cells before falling back to OCCT
+const double kSnapRelative = 1e-12;           // Coordinates closer than this x extent are merged
+const int kCacheLimit = 1024;
+
+// Decompositions of solids produced by perform(), so chained operations on
+// them stay analytic
+std::mutex cacheMutex;
+NCollection_DataMap<TopoDS_Shape, std::vector<AxisBox>, TopTools_ShapeMapHasher> decompositionCache;
+
+bool findCached(const TopoDS_Shape& solid, std::vector<AxisBox>& boxes) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return decompositionCache.Find(solid, boxes);
+}
+
+void storeCached(const TopoDS_Shape& solid, const std::vector<AxisBox>& boxes) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (decompositionCache.Extent() >= kCacheLimit) {
+        decompositionCache.Clear();
+    }
+    decompositionCache.Bind(solid, boxes);
+}
+
+// A solid is an axis-aligned box when it has six planar faces, one on each
+// side of the box spanned by its vertices
+bool isAxisBox(const TopoDS_Shape& solid, AxisBox& box) {
+    bool first = true;
+    for (TopExp_Explorer exp(solid, TopAbs_VERTEX); exp.More(); exp.Next()) {
+        gp_Pnt p = BRep_Tool::Pnt(TopoDS::Vertex(exp.Current()));
+        for (int a = 0; a < 3; a++) {
+            double c = p.Coord(a + 1);
+            if (first || c < box.min[a]) box.min[a] = c;
+            if (first || c > box.max[a]) box.max[a] = c;
+        }
+        first = false;
+    }
+    if (first) {
+        return false;
+    }
+    for (int a = 0; a < 3; a++) {
+        if (!(box.max[a] > box.min[a])) {
+            return false;
+        }
+    }
+
+    // Every vertex must be a corner
+    for (TopExp_Explorer exp(solid, TopAbs_VERTEX); exp.More(); exp.Next()) {
+        gp_Pnt p = BRep_Tool::Pnt(TopoDS::Vertex(exp.Current()));
+        for (int a = 0; a < 3; a++) {
+            double c = p.Coord(a + 1);
+            if (c != box.min[a] && c != box.max[a]) {
+                return false;
+            }
+        }
+    }
+
+    int faceCount = 0;
+    unsigned sides = 0;
+    for (TopExp_Explorer exp(solid, TopAbs_FACE); exp.More(); exp.Next()) {
+        if (++faceCount > 6) {
+            return false;
+        }
+        BRepAdaptor_Surface surface(TopoDS::Face(exp.Current()), false);
+        if (surface.GetType() != GeomAbs_Plane) {
+            return false;
+        }
+        gp_Pln plane = surface.Plane();
+        const gp_Dir& normal = plane.Axis().Direction();
+        int axis = -1;
+        for (int a = 0; a < 3; a++) {
+            if (std::abs(normal.Coord(a + 1)) > 1.0 - 1e-12) {
+                axis = a;
+            }
+        }
+        if (axis < 0) {
+            return false;
+        }
+        double position = plane.Location().Coord(axis + 1);
+        double tolerance = 1e-9 * (box.max[axis] - box.min[axis]);
+        if (std::abs(position - box.min[axis]) <= tolerance) {
+            sides |= 1u << (2 * axis);
+        } else if (std::abs(position - box.max[axis]) <= tolerance) {
+            sides |= 1u << (2 * axis + 1);
+        } else {
+            return false;
+        }
+    }
+    return faceCount == 6 && sides == 0x3f;
+}
+
+// Sorted grid coordinates along one axis, with input values closer than the
+// snap distance merged onto the smallest of them
+struct GridAxis {
+    std::vector<double> raw;          // Every input value, sorted
+    std::vector<std::int32_t> node;   // Grid node of raw[i]
+    std::vector<double> coords;       // Coordinate of each grid node
+
+    void build(std::vector<double> values, double snap) {
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        raw = values;
+        node.resize(raw.size());
+        coords.clear();
+        for (size_t i = 0; i < raw.size(); i++) {
+            if (coords.empty() || raw[i] - raw[i - 1] > snap) {
+                coords.push_back(raw[i]);
+            }
+            node[i] = static_cast<std::int32_t>(coords.size() - 1);
+        }
+    }
+
+    std::int32_t nodeOf(double value) const {
+        return node[std::lower_bound(raw.begin(), raw.end(), value) - raw.begin()];
+    }
+
+    std::int32_t cellCount() const { return static_cast<std::int32_t>(coords.size()) - 1; }
+};
+
+struct Grid {
+    GridAxis axes[3];
+    std::int32_t n[3];
+
+    size_t cellCount() const { return size_t(n[0]) * size_t(n[1]) * size_t(n[2]); }
+    size_t cell(std::int32_t i, std::int32_t j, std::int32_t k) const {
+        return size_t(i) + size_t(n[0]) * (size_t(j) + size_t(n[1]) * size_t(k));
+    }
+    std::uint64_t node(const std::int32_t c[3]) const {
+        return std::uint64_t(c[0]) + std::uint64_t(n[0] + 1) * (std::uint64_t(c[1]) + std::uint64_t(n[1] + 1) * std::uint64_t(c[2]));
+    }
+    gp_Pnt point(const std::int32_t c[3]) const {
+        return gp_Pnt(axes[0].coords[c[0]], axes[1].coords[c[1]], axes[2].coords[c[2]]);
+    }
+};
+
+void rasterize(const Grid& grid, const std::vector<AxisBox>& boxes, std::uint8_t value,
+               std::vector<std::uint8_t>& cells) {
+    for (const AxisBox& box : boxes) {
+        std::int32_t lo[3], hi[3];
+        for (int a = 0; a < 3; a++) {
+            lo[a] = grid.axes[a].nodeOf(box.min[a]);
+            hi[a] = grid.axes[a].nodeOf(box.max[a]);
+        }
+        for (std::int32_t k = lo[2]; k < hi[2]; k++) {
+            for (std::int32_t j = lo[1]; j < hi[1]; j++) {
+                for (std::int32_t i = lo[0]; i < hi[0]; i++) {
+                    cells[grid.cell(i, j, k)] = value;
+                }
+            }
+        }
+    }
+}
+
+// One face of a boundary cell: corner nodes counter-clockwise seen from outside
+struct BoundaryQuad {
+    std::int32_t corners[4][3];
+    int axis;
+    int side;
+};
+
+std::uint64_t edgeKey(std::uint64_t a, std::uint64_t b) {
+    return a < b ? (a << 32) | b : (b << 32) | a;
+}
+
+size_t findRoot(std::vector<size_t>& parent, size_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// Boundary rectangle on the plane at grid node `level` along `axis`, spanning
+// grid nodes lo..hi along the two other axes (u = axis+1, v = axis+2)
+struct BoundaryRect {
+    int axis;
+    int side;
+    std::int32_t level;
+    std::int32_t lo[2];
+    std::int32_t hi[2];
+
+    // Corner nodes counter-clockwise seen from outside, as for BoundaryQuad
+    void corners(std::int32_t c[4][3]) const {
+        const int u = (axis + 1) % 3;
+        const int v = (axis + 2) % 3;
+        const std::int32_t us[4] = {lo[0], hi[0], hi[0], lo[0]};
+        const std::int32_t vs[4] = {lo[1], lo[1], hi[1], hi[1]};
+        for (int q = 0; q < 4; q++) {
+            int corner = side ? q : 3 - q;
+            c[q][axis] = level;
+            c[q][u] = us[corner];
+            c[q][v] = vs[corner];
+        }
+    }
+};
+
+// Greedy merge of the quads of each plane into rectangles, the 2D
+// counterpart of mergeCells
+std::vector<BoundaryRect> mergeQuads(const std::vector<BoundaryQuad>& quads) {
+    // Quads per plane (axis, side, level) as (u, v) cell positions
+    std::map<std::tuple<int, int, std::int32_t>, std::vector<std::pair<std::int32_t, std::int32_t>>> planes;
+    for (const BoundaryQuad& quad : quads) {
+        const int u = (quad.axis + 1) % 3;
+        const int v = (quad.axis + 2) % 3;
+        std::int32_t cu = std::min(std::min(quad.corners[0][u], quad.corners[1][u]), quad.corners[2][u]);
+        std::int32_t cv = std::min(std::min(quad.corners[0][v], quad.corners[1][v]), quad.corners[2][v]);
+        planes[std::make_tuple(quad.axis, quad.side, quad.corners[0][quad.axis])].emplace_back(cu, cv);
+    }
+
+    std::vector<BoundaryRect> rects;
+    std::vector<std::uint8_t> mask;
+    for (auto& plane : planes) {
+        auto& cells = plane.second;
+        std::int32_t u0 = cells.front().first, u1 = u0, v0 = cells.front().second, v1 = v0;
+        for (const auto& c : cells) {
+            u0 = std::min(u0, c.first);
+            u1 = std::max(u1, c.first);
+            v0 = std::min(v0, c.second);
+            v1 = std::max(v1, c.second);
+        }
+        const size_t width = size_t(u1 - u0 + 1);
+        mask.assign(width * size_t(v1 - v0 + 1), 0);
+        auto at = [&](std::int32_t u, std::int32_t v) -> std::uint8_t& {
+            return mask[size_t(u - u0) + width * size_t(v - v0)];
+        };
+        for (const auto& c : cells) {
+            at(c.first, c.second) = 1;
+        }
+
+        // Cells in row order, each free one growing along u, then along v
+        std::sort(cells.begin(), cells.end(), [](const std::pair<std::int32_t, std::int32_t>& a,
+                                                 const std::pair<std::int32_t, std::int32_t>& b) {
+            return a.second != b.second ? a.second < b.second : a.first < b.first;
+        });
+        for (const auto& c : cells) {
+            if (!at(c.first, c.second)) {
+                continue;
+            }
+            std::int32_t uEnd = c.first + 1;
+            while (uEnd <= u1 && at(uEnd, c.second)) uEnd++;
+            std::int32_t vEnd = c.second + 1;
+            for (; vEnd <= v1; vEnd++) {
+                bool full = true;
+                for (std::int32_t u = c.first; u < uEnd && full; u++) full = at(u, vEnd) != 0;
+                if (!full) break;
+            }
+            for (std::int32_t v = c.second; v < vEnd; v++) {
+                for (std::int32_t u = c.first; u < uEnd; u++) at(u, v) = 0;
+            }
+
+            BoundaryRect rect;
+            rect.axis = std::get<0>(plane.first);
+            rect.side = std::get<1>(plane.first);
+            rect.level = std::get<2>(plane.first);
+            rect.lo[0] = c.first;
+            rect.lo[1] = c.second;
+            rect.hi[0] = uEnd;
+            rect.hi[1] = vEnd;
+            rects.push_back(rect);
+        }
+    }
+    return rects;
+}
+
+// Builds the closed solid bounded by the quads of one connected component.
+// Coplanar quads are merged into rectangles before any BRep is built;
+// vertices and edges are shared between rectangles, and
+// ShapeUpgrade_UnifySameDomain joins the remaining coplanar rectangles.
+bool buildSolid(const Grid& grid, const std::vector<BoundaryQuad>& quads, TopoDS_Solid& solid) {
+    // Each edge must bound exactly two quads and all quads must form a
+    // single shell; anything else (cavities, edge-touching blocks) is left
+    // to OCCT
+    std::unordered_map<std::uint64_t, std::pair<size_t, int>> edgeUse;
+    std::vector<size_t> parent(quads.size());
+    for (size_t q = 0; q < quads.size(); q++) {
+        parent[q] = q;
+    }
+    for (size_t q = 0; q < quads.size(); q++) {
+        for (int c = 0; c < 4; c++) {
+            std::uint64_t key = edgeKey(grid.node(quads[q].corners[c]), grid.node(quads[q].corners[(c + 1) % 4]));
+            auto it = edgeUse.find(key);
+            if (it == edgeUse.end()) {
+                edgeUse.emplace(key, std::make_pair(q, 1));
+            } else {
+                if (++it->second.second > 2) {
+                    return false;
+                }
+                parent[findRoot(parent, q)] = findRoot(parent, it->second.first);
+            }
+        }
+    }
+    for (const auto& use : edgeUse) {
+        if (use.second.second != 2) {
+            return false;
+        }
+    }
+    for (size_t q = 0; q < quads.size(); q++) {
+        if (findRoot(parent, q) != findRoot(parent, 0)) {
+            return false;
+        }
+    }
+
+    // Merge coplanar quads into rectangles, so a large flat side becomes one
+    // face instead of one face per grid cell
+    std::vector<BoundaryRect> rects = mergeQuads(quads);
+
+    // Rectangle corners are where edges must end. Sides are split at every
+    // corner lying on them, so rectangles meeting along a side (coplanar or
+    // not) share the same edges.
+    std::unordered_set<std::uint64_t> corners;
+    for (const BoundaryRect& rect : rects) {
+        std::int32_t c[4][3];
+        rect.corners(c);
+        for (int k = 0; k < 4; k++) {
+            corners.insert(grid.node(c[k]));
+        }
+    }
+
+    BRep_Builder builder;
+    std::unordered_map<std::uint64_t, TopoDS_Vertex> vertices;
+    std::unordered_map<std::uint64_t, TopoDS_Edge> edges;   // Oriented from the lower node id
+    auto vertexAt = [&](const std::int32_t c[3]) -> const TopoDS_Vertex& {
+        std::uint64_t id = grid.node(c);
+        auto it = vertices.find(id);
+        if (it == vertices.end()) {
+            it = vertices.emplace(id, BRepBuilderAPI_MakeVertex(grid.point(c)).Vertex()).first;
+        }
+        return it->second;
+    };
+    auto addEdge = [&](TopoDS_Wire& wire, const std::int32_t from[3], const std::int32_t to[3]) {
+        std::uint64_t a = grid.node(from);
+        std::uint64_t b = grid.node(to);
+        std::uint64_t key = edgeKey(a, b);
+        auto it = edges.find(key);
+        if (it == edges.end()) {
+            const TopoDS_Vertex& va = vertexAt(a < b ? from : to);
+            const TopoDS_Vertex& vb = vertexAt(a < b ? to : from);
+            BRepBuilderAPI_MakeEdge edgeMaker(va, vb);
+            if (!edgeMaker.IsDone()) {
+                return false;
+            }
+            it = edges.emplace(key, edgeMaker.Edge()).first;
+        }
+        builder.Add(wire, a < b ? it->second : TopoDS::Edge(it->second.Reversed()));
+        return true;
+    };
+
+    TopoDS_Shell shell;
+    builder.MakeShell(shell);
+    for (const BoundaryRect& rect : rects) {
+        std::int32_t c[4][3];
+        rect.corners(c);
+        TopoDS_Wire wire;
+        builder.MakeWire(wire);
+        for (int k = 0; k < 4; k++) {
+            // Walk the side one grid step at a time, closing an edge at
+            // every corner of another rectangle
+            const std::int32_t* end = c[(k + 1) % 4];
+            std::int32_t from[3] = {c[k][0], c[k][1], c[k][2]};
+            std::int32_t at[3] = {from[0], from[1], from[2]};
+            int axis = (end[0] != at[0]) ? 0 : (end[1] != at[1]) ? 1 : 2;
+            int step = end[axis] > at[axis] ? 1 : -1;
+            while (at[axis] != end[axis]) {
+                at[axis] += step;
+                if (at[axis] == end[axis] || corners.count(grid.node(at))) {
+                    if (!addEdge(wire, from, at)) {
+                        return false;
+                    }
+                    from[0] = at[0];
+                    from[1] = at[1];
+                    from[2] = at[2];
+                }
+            }
+        }
+        wire.Closed(true);
+
+        gp_Dir normal(rect.axis == 0 ? 1.0 : 0.0, rect.axis == 1 ? 1.0 : 0.0, rect.axis == 2 ? 1.0 : 0.0);
+        if (rect.side == 0) {
+            normal.Reverse();
+        }
+        BRepBuilderAPI_MakeFace faceMaker(gp_Pln(grid.point(c[0]), normal), wire, true);
+        if (!faceMaker.IsDone()) {
+            return false;
+        }
+        builder.Add(shell, faceMaker.Face());
+    }
+    shell.Closed(true);
+
+    TopoDS_Solid raw;
+    builder.MakeSolid(raw);
+    builder.Add(raw, shell);
+    BRepLib::OrientClosedSolid(raw);
+
+    ShapeUpgrade_UnifySameDomain unify(raw, true, true, false);
+    unify.Build();
+    TopExp_Explorer exp(unify.Shape(), TopAbs_SOLID);
+    if (!exp.More()) {
+        return false;
+    }
+    solid = TopoDS::Solid(exp.Current());
+    return true;
+}
+
+// Greedy merge of a component's cells into few boxes, for the cache
+std::vector<AxisBox> mergeCells(const Grid& grid, const std::vector<std::int32_t>& label,
+                                std::int32_t component, std::vector<size_t> cells,
+                                std::vector<std::uint8_t>& used) {
+    std::vector<AxisBox> boxes;
+    std::sort(cells.begin(), cells.end());
+    auto free = [&](std::int32_t i, std::int32_t j, std::int32_t k) {
+        size_t c = grid.cell(i, j, k);
+        return label[c] == component && !used[c];
+    };
+    for (size_t start : cells) {
+        if (used[start]) {
+            continue;
+        }
+        std::int32_t i0 = static_cast<std::int32_t>(start % grid.n[0]);
+        std::int32_t j0 = static_cast<std::int32_t>((start / grid.n[0]) % grid.n[1]);
+        std::int32_t k0 = static_cast<std::int32_t>(start / (size_t(grid.n[0]) * grid.n[1]));
+
+        std::int32_t i1 = i0 + 1;
+        while (i1 < grid.n[0] && free(i1, j0, k0)) i1++;
+        std::int32_t j1 = j0 + 1;
+        for (; j1 < grid.n[1]; j1++) {
+            bool full = true;
+            for (std::int32_t i = i0; i < i1 && full; i++) full = free(i, j1, k0);
+            if (!full) break;
+        }
+        std::int32_t k1 = k0 + 1;
+        for (; k1 < grid.n[2]; k1++) {
+            bool full = true;
+            for (std::int32_t j = j0; j < j1 && full; j++) {
+                for (std::int32_t i = i0; i < i1 && full; i++) full = free(i, j, k1);
+            }
+            if (!full) break;
+        }
+
+        for (std::int32_t k = k0; k < k1; k++) {
+            for (std::int32_t j = j0; j < j1; j++) {
+                for (std::int32_t i = i0; i < i1; i++) used[grid.cell(i, j, k)] = 1;
+            }
+        }
+        AxisBox box;
+        const std::int32_t lo[3] = {i0, j0, k0};
+        const std::int32_t hi[3] = {i1, j1, k1};
+        for (int a = 0; a < 3; a++) {
+            box.min[a] = grid.axes[a].coords[lo[a]];
+            box.max[a] = grid.axes[a].coords[hi[a]];
+        }
+        boxes.push_back(box);
+    }
+    return boxes;
+}
+
+} // namespace
+
+bool BoxBooleanEngine::decompose(const TopoDS_Shape& shape, std::vector<AxisBox>& boxes) {
+    if (shape.IsNull()) {
+        return false;
+    }
+    try {
+        // Faces outside solids (open shells, loose faces) are not volumes
+        if (TopExp_Explorer(shape, TopAbs_FACE, TopAbs_SOLID).More()) {
+            return false;
+        }
+        std::vector<AxisBox> found;
+        for (TopExp_Explorer exp(shape, TopAbs_SOLID); exp.More(); exp.Next()) {
+            const TopoDS_Shape& solid = exp.Current();
+            if (solid.Orientation() != TopAbs_FORWARD) {
+                return false;
+            }
+            std::vector<AxisBox> cached;
+            if (findCached(solid, cached)) {
+                found.insert(found.end(), cached.begin(), cached.end());
+                continue;
+            }
+            AxisBox box;
+            if (!isAxisBox(solid, box)) {
+                return false;
+            }
+            found.push_back(box);
+        }
+        // A shape without solids is only accepted when it is entirely empty
+        if (found.empty() && TopExp_Explorer(shape, TopAbs_VERTEX).More()) {
+            return false;
+        }
+        boxes.swap(found);
+        return true;
+    } catch (const Standard_Failure&) {
+        return false;
+    }
+}
+
+bool BoxBooleanEngine::perform(BoxBooleanOp op, const std::vector<TopoDS_Shape>& operands,
+                               TopoDS_Shape& result) {
+    if (operands.empty()) {
+        return false;
+    }
+    std::vector<std::vector<AxisBox>> operandBoxes(operands.size());
+    for (size_t i = 0; i < operands.size(); i++) {
+        if (!decompose(operands[i], operandBoxes[i])) {
+            return false;
+        }
+    }
+
+    try {
+        // Grid spanned by every box coordinate
+        Grid grid;
+        double extent = 0.0;
+        std::vector<double> values[3];
+        for (const auto& boxes : operandBoxes) {
+            for (const AxisBox& box : boxes) {
+                for (int a = 0; a < 3; a++) {
+                    values[a].push_back(box.min[a]);
+                    values[a].push_back(box.max[a]);
+                    extent = std::max(extent, std::max(std::abs(box.min[a]), std::abs(box.max[a])));
+                }
+            }
+        }
+        size_t cellCount = 1;
+        for (int a = 0; a < 3; a++) {
+            grid.axes[a].build(values[a], kSnapRelative * extent);
+            grid.n[a] = std::max<std::int32_t>(grid.axes[a].cellCount(), 0);
+            cellCount *= size_t(grid.n[a]);
+            if (cellCount > kMaxCells) {
+                return false;
+            }
+        }
+
+        std::vector<std::uint8_t> inside(cellCount, 0);
+        if (cellCount > 0) {
+            rasterize(grid, operandBoxes[0], 1, inside);
+            for (size_t i = 1; i < operands.size(); i++) {
+                if (op == BoxBooleanOp::Union) {
+                    rasterize(grid, operandBoxes[i], 1, inside);
+                } else if (op == BoxBooleanOp::Cut) {
+                    rasterize(grid, operandBoxes[i], 0, inside);
+                } else {
+                    std::vector<std::uint8_t> mask(cellCount, 0);
+                    rasterize(grid, operandBoxes[i], 1, mask);
+                    for (size_t c = 0; c < cellCount; c++) {
+                        inside[c] &= mask[c];
+                    }
+                }
+            }
+        }
+
+        // Face-connected components, each becoming one solid
+        std::vector<std::int32_t> label(cellCount, -1);
+        std::vector<std::vector<size_t>> components;
+        std::vector<size_t> stack;
+        for (size_t seed = 0; seed < cellCount; seed++) {
+            if (!inside[seed] || label[seed] >= 0) {
+                continue;
+            }
+            std::int32_t id = static_cast<std::int32_t>(components.size());
+            components.emplace_back();
+            label[seed] = id;
+            stack.push_back(seed);
+            while (!stack.empty()) {
+                size_t c = stack.back();
+                stack.pop_back();
+                components.back().push_back(c);
+                std::int32_t ijk[3] = {
+                    static_cast<std::int32_t>(c % grid.n[0]),
+                    static_cast<std::int32_t>((c / grid.n[0]) % grid.n[1]),
+                    static_cast<std::int32_t>(c / (size_t(grid.n[0]) * grid.n[1]))};
+                for (int a = 0; a < 3; a++) {
+                    for (int step = -1; step <= 1; step += 2) {
+                        std::int32_t nb[3] = {ijk[0], ijk[1], ijk[2]};
+                        nb[a] += step;
+                        if (nb[a] < 0 || nb[a] >= grid.n[a]) {
+                            continue;
+                        }
+                        size_t nc = grid.cell(nb[0], nb[1], nb[2]);
+                        if (inside[nc] && label[nc] < 0) {
+                            label[nc] = id;
+                            stack.push_back(nc);
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<TopoDS_Solid> solids;
+        std::vector<std::vector<AxisBox>> solidBoxes;
+        std::vector<std::uint8_t> merged(cellCount, 0);
+        for (size_t id = 0; id < components.size(); id++) {
+            std::vector<BoundaryQuad> quads;
+            for (size_t c : components[id]) {
+                std::int32_t ijk[3] = {
+                    static_cast<std::int32_t>(c % grid.n[0]),
+                    static_cast<std::int32_t>((c / grid.n[0]) % grid.n[1]),
+                    static_cast<std::int32_t>(c / (size_t(grid.n[0]) * grid.n[1]))};
+                for (int a = 0; a < 3; a++) {
+                    for (int side = 0; side < 2; side++) {
+                        std::int32_t nb[3] = {ijk[0], ijk[1], ijk[2]};
+                        nb[a] += side ? 1 : -1;
+                        if (nb[a] >= 0 && nb[a] < grid.n[a] && inside[grid.cell(nb[0], nb[1], nb[2])]) {
+                            continue;
+                        }
+                        // (u, v, a) is right-handed, so u-then-v is
+                        // counter-clockwise seen from +a
+                        int u = (a + 1) % 3;
+                        int v = (a + 2) % 3;
+                        const int du[4] = {0, 1, 1, 0};
+                        const int dv[4] = {0, 0, 1, 1};
+                        BoundaryQuad quad;
+                        quad.axis = a;
+                        quad.side = side;
+                        for (int q = 0; q < 4; q++) {
+                            int corner = side ? q : 3 - q;
+                            quad.corners[q][a] = ijk[a] + side;
+                            quad.corners[q][u] = ijk[u] + du[corner];
+                            quad.corners[q][v] = ijk[v] + dv[corner];
+                        }
+                        quads.push_back(quad);
+                    }
+                }
+            }
+            TopoDS_Solid solid;
+            if (!buildSolid(grid, quads, solid)) {
+                return false;
+            }
+            solids.push_back(solid);
+            solidBoxes.push_back(mergeCells(grid, label, static_cast<std::int32_t>(id), components[id], merged));
+        }
+
+        for (size_t i = 0; i < solids.size(); i++) {
+            storeCached(solids[i], solidBoxes[i]);
+        }
+        if (solids.size() == 1) {
+            result = solids.front();
+        } else {
+            TopoDS_Compound compound;
+            BRep_Builder builder;
+            builder.MakeCompound(compound);
+            for (const TopoDS_Solid& solid : solids) {
+                builder.Add(compound, solid);
+            }
+            result = compound;
+        }
+        return true;
+    } catch (const Standard_Failure&) {
+        return false;
+    }
+}
+
+void BoxBooleanEngine::clearCache() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    decompositionCache.Clear();
+}
@@ -0,0 +1,269 @@
+// GLBExporter.cpp
+#include "GLBExporter.h"
+#include "BoundaryMesh.h"
+#include "OutputSink.h"
+#include "ParallelUtils.h"
+#include "SemiconductorDevice.h"
+#include "VTKExporter.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const std::uint32_t kGlbMagic = 0x46546C67;      // "glTF"
+const std::uint32_t kGlbVersion = 2;
+const std::uint32_t kChunkJson = 0x4E4F534A;     // "JSON"
+const std::uint32_t kChunkBin = 0x004E4942;      // "BIN\0"
+const int kComponentFloat = 5126;
+const int kComponentUnsignedInt = 5125;
+const int kTargetArrayBuffer = 34962;
+const int kTargetElementArrayBuffer = 34963;
+const size_t kPositionStride = 3 * sizeof(float);
+
+// One glTF primitive: a mesh plus the material it is drawn with
+struct GLBPrimitive {
+    const BoundaryMesh* mesh;
+    std::string name;
+    float color[3];
+    float metallic;
+    int materialId;
+    int regionId;
+};
+
+void baseColor(MaterialType material, float color[3], float& metallic) {
+    static const float palette[][3] = {
+        {0.55f, 0.57f, 0.62f},  // Silicon
+        {0.45f, 0.55f, 0.70f},  // GermaniumSilicon
+        {0.62f, 0.45f, 0.30f},  // GalliumArsenide
+        {0.72f, 0.52f, 0.30f},  // IndiumGalliumArsenide
+        {0.30f, 0.68f, 0.42f},  // Silicon_Nitride
+        {0.75f, 0.85f, 0.95f},  // Silicon_Dioxide
+        {0.85f, 0.70f, 0.30f},  // Metal_Contact
+    };
+    const size_t index = std::min<size_t>(static_cast<size_t>(material), 6);
+    std::copy(palette[index], palette[index] + 3, color);
+    metallic = (material == MaterialType::Metal_Contact) ? 1.0f : 0.0f;
+}
+
+void writeJsonString(OutputSink& json, const std::string& text) {
+    json << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            json << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            static const char hex[] = "0123456789abcdef";
+            json << "\\u00" << hex[(c >> 4) & 0xF] << hex[c & 0xF];
+        } else {
+            json << c;
+        }
+    }
+    json << '"';
+}
+
+// Layout of the binary chunk: all positions (one bufferView with stride
+// 12), then all indices (one bufferView). Each primitive addresses its range
+// through accessor byte offsets, so indices stay local to their primitive
+// and are copied without renumbering.
+void writeGLB(const std::vector<GLBPrimitive>& primitives, OutputSink& out) {
+    const size_t count = primitives.size();
+    std::vector<size_t> positionOffsets(count + 1, 0);
+    std::vector<size_t> indexOffsets(count + 1, 0);
+    for (size_t p = 0; p < count; p++) {
+        positionOffsets[p + 1] = positionOffsets[p] + primitives[p].mesh->getNodeCount() * kPositionStride;
+        indexOffsets[p + 1] = indexOffsets[p] + primitives[p].mesh->getElementArrays().triangles.size() * sizeof(std::uint32_t);
+    }
+    const size_t positionBytes = positionOffsets[count];
+    const size_t indexBytes = indexOffsets[count];
+    const size_t binBytes = positionBytes + indexBytes;  // Multiple of 4 by construction
+    if (binBytes > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("Mesh too large for a single GLB buffer");
+    }
+
+    // Single pass into the final buffer: float32 positions with per-chunk
+    // bounds (glTF requires POSITION min/max), then the index arrays
+    std::vector<unsigned char> bin(binBytes);
+    const size_t grain = 1 << 14;
+    std::vector<std::array<float, 6>> bounds(count);
+    for (size_t p = 0; p < count; p++) {
+        const MeshNodeArrays& nodes = primitives[p].mesh->getNodeArrays();
+        const size_t nodeCount = nodes.size();
+        unsigned char* dst = bin.data() + positionOffsets[p];
+
+        std::vector<std::array<float, 6>> chunkBounds((nodeCount + grain - 1) / grain);
+        parallelForChunks(nodeCount, grain, [&](size_t begin, size_t end) {
+            std::array<float, 6> box = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                                        std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(),
+                                        std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+            for (size_t i = begin; i < end; i++) {
+                const float xyz[3] = {static_cast<float>(nodes.x[i]), static_cast<float>(nodes.y[i]),
+                                      static_cast<float>(nodes.z[i])};
+                std::memcpy(dst + i * kPositionStride, xyz, kPositionStride);
+                for (int k = 0; k < 3; k++) {
+                    box[k] = std::min(box[k], xyz[k]);
+                    box[3 + k] = std::max(box[3 + k], xyz[k]);
+                }
+            }
+            chunkBounds[begin / grain] = box;
+        });
+
+        bounds[p] = chunkBounds[0];
+        for (const auto& box : chunkBounds) {
+            for (int k = 0; k < 3; k++) {
+                bounds[p][k] = std::min(bounds[p][k], box[k]);
+                bounds[p][3 + k] = std::max(bounds[p][3 + k], box[3 + k]);
+            }
+        }
+
+        // Node indices are non-negative int32, bit-identical to uint32
+        const std::vector<std::int32_t>& triangles = primitives[p].mesh->getElementArrays().triangles;
+        unsigned char* indexDst = bin.data() + positionBytes + indexOffsets[p];
+        parallelForChunks(triangles.size(), 1 << 16, [&](size_t begin, size_t end) {
+            std::memcpy(indexDst + begin * sizeof(std::uint32_t), triangles.data() + begin,
+                        (end - begin) * sizeof(std::uint32_t));
+        });
+    }
+
+    // JSON chunk
+    std::vector<char> jsonText;
+    {
+        OutputSink json(jsonText);
+        json << "{\"asset\":{\"version\":\"2.0\",\"generator\":\"SemiconductorDevice GLBExporter\"},"
+             << "\"scene\":0,\"scenes\":[{\"nodes\":[0]}],"
+             << "\"nodes\":[{\"mesh\":0,\"name\":\"SemiconductorDevice\"}],"
+             << "\"meshes\":[{\"name\":\"SemiconductorDevice\",\"primitives\":[";
+        for (size_t p = 0; p < count; p++) {
+            json << (p ? "," : "") << "{\"attributes\":{\"POSITION\":" << 2 * p << "},\"indices\":" << 2 * p + 1
+                 << ",\"material\":" << p << ",\"mode\":4}";
+        }
+        json << "]}],\"materials\":[";
+        for (size_t p = 0; p < count; p++) {
+            const GLBPrimitive& primitive = primitives[p];
+            json << (p ? "," : "") << "{\"name\":";
+            writeJsonString(json, primitive.name);
+            json << ",\"pbrMetallicRoughness\":{\"baseColorFactor\":[" << primitive.color[0] << ','
+                 << primitive.color[1] << ',' << primitive.color[2] << ",1],\"metallicFactor\":"
+                 << primitive.metallic << ",\"roughnessFactor\":0.6},\"doubleSided\":true,"
+                 << "\"extras\":{\"materialId\":" << primitive.materialId << ",\"regionId\":" << primitive.regionId
+                 << "}}";
+        }
+        json << "],\"buffers\":[{\"byteLength\":" << binBytes << "}],"
+             << "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" << positionBytes
+             << ",\"byteStride\":" << kPositionStride << ",\"target\":" << kTargetArrayBuffer << "},"
+             << "{\"buffer\":0,\"byteOffset\":" << positionBytes << ",\"byteLength\":" << indexBytes
+             << ",\"target\":" << kTargetElementArrayBuffer << "}],\"accessors\":[";
+        for (size_t p = 0; p < count; p++) {
+            const std::array<float, 6>& box = bounds[p];
+            json << (p ? "," : "") << "{\"bufferView\":0,\"byteOffset\":" << positionOffsets[p]
+                 << ",\"componentType\":" << kComponentFloat << ",\"count\":" << primitives[p].mesh->getNodeCount()
+                 << ",\"type\":\"VEC3\",\"min\":[" << box[0] << ',' << box[1] << ',' << box[2] << "],\"max\":["
+                 << box[3] << ',' << box[4] << ',' << box[5] << "]},"
+                 << "{\"bufferView\":1,\"byteOffset\":" << indexOffsets[p] << ",\"componentType\":"
+                 << kComponentUnsignedInt << ",\"count\":" << primitives[p].mesh->getElementArrays().triangles.size()
+                 << ",\"type\":\"SCALAR\"}";
+        }
+        json << "]}";
+        // Chunks are 4-byte aligned; JSON pads with spaces
+        while (json.bytesWritten() % 4 != 0) json << ' ';
+        json.close();
+    }
+
+    const std::uint32_t totalLength = static_cast<std::uint32_t>(12 + 8 + jsonText.size() + 8 + binBytes);
+    out.writeLittleEndian(kGlbMagic);
+    out.writeLittleEndian(kGlbVersion);
+    out.writeLittleEndian(totalLength);
+    out.writeLittleEndian(static_cast<std::uint32_t>(jsonText.size()));
+    out.writeLittleEndian(kChunkJson);
+    out.write(jsonText.data(), jsonText.size());
+    out.writeLittleEndian(static_cast<std::uint32_t>(binBytes));
+    out.writeLittleEndian(kChunkBin);
+    out.write(bin.data(), bin.size());
+    out.flush();
+}
+
+bool writePrimitives(const std::vector<GLBPrimitive>& primitives, OutputSink& out) {
+    try {
+        writeGLB(primitives, out);
+    } catch (const std::exception& e) {
+        std::cerr << "Error writing GLB data: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool writePrimitives(const std::vector<GLBPrimitive>& primitives, const std::string& filename) {
+    try {
+        OutputSink out(filename);
+        writeGLB(primitives, out);
+        out.close();
+    } catch (const std::exception& e) {
+        std::cerr << "Error writing GLB file: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool meshPrimitives(const BoundaryMesh& mesh, std::vector<GLBPrimitive>& primitives) {
+    if (mesh.getNodeCount() == 0 || mesh.getElementCount() == 0) {
+        std::cerr << "No mesh data available for GLB export" << std::endl;
+        return false;
+    }
+    GLBPrimitive primitive{&mesh, "BoundaryMesh", {}, 0.0f, 0, 0};
+    baseColor(MaterialType::Silicon, primitive.color, primitive.metallic);
+    primitives.push_back(primitive);
+    return true;
+}
+
+bool devicePrimitives(const SemiconductorDevice& device, std::vector<GLBPrimitive>& primitives) {
+    for (const auto& layer : device.getLayers()) {
+        const BoundaryMesh* mesh = layer->getBoundaryMesh();
+        if (!mesh || mesh->getNodeCount() == 0 || mesh->getElementCount() == 0) continue;
+        GLBPrimitive primitive{mesh, layer->getName(), {}, 0.0f,
+                               VTKExporter::materialTypeToID(layer->getMaterial().type),
+                               VTKExporter::deviceRegionToID(layer->getRegion())};
+        baseColor(layer->getMaterial().type, primitive.color, primitive.metallic);
+        primitives.push_back(primitive);
+    }
+    if (primitives.empty()) {
+        std::cerr << "No layer meshes available for export" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool GLBExporter::exportMesh(const BoundaryMesh& mesh, const std::string& filename) {
+    std::vector<GLBPrimitive> primitives;
+    if (!meshPrimitives(mesh, primitives) || !writePrimitives(primitives, filename)) {
+        return false;
+    }
+    std::cout << "Exported mesh to GLB file: " << filename << std::endl;
+    return true;
+}
+
+bool GLBExporter::exportMesh(const BoundaryMesh& mesh, OutputSink& out) {
+    std::vector<GLBPrimitive> primitives;
+    return meshPrimitives(mesh, primitives) && writePrimitives(primitives, out);
+}
+
+bool GLBExporter::exportDevice(const SemiconductorDevice& device, const std::string& filename) {
+    std::vector<GLBPrimitive> primitives;
+    if (!devicePrimitives(device, primitives) || !writePrimitives(primitives, filename)) {
+        return false;
+    }
+    std::cout << "Exported device mesh to GLB file: " << filename << std::endl;
+    std::cout << "  Primitives (layers): " << primitives.size() << std::endl;
+    return true;
+}
+
+bool GLBExporter::exportDevice(const SemiconductorDevice& device, OutputSink& out) {
+    std::vector<GLBPrimitive> primitives;
+    return devicePrimitives(device, primitives) && writePrimitives(primitives, out);
+}
@@ -1,4 +1,6 @@
 #include "GeometryBuilder.h"
+#include "BoxBooleanEngine.h"
+#include "BooleanResultCache.h"
 
 #include <iostream>
 #include <stdexcept>
@@ -18,6 +20,12 @@
 #include <BRepAlgoAPI_Fuse.hxx>
 #include <BRepAlgoAPI_Cut.hxx>
 #include <BRepAlgoAPI_Common.hxx>
+#include <BRepAlgoAPI_BuilderAlgo.hxx>
+#include <TopTools_ListOfShape.hxx>
+#include <TopTools_ListIteratorOfListOfShape.hxx>
+#include <TopTools_MapOfShape.hxx>
+#include <TopoDS_Compound.hxx>
+#include <BRep_Builder.hxx>
 #include <BRepGProp.hxx>
 #include <GProp_GProps.hxx>
 #include <TopExp_Explorer.hxx>
@@ -38,6 +46,98 @@
 #include <ShapeFix_Shape.hxx>
 #include <BRepLib.hxx>
 #include <Standard_Failure.hxx>
+#include <NCollection_DataMap.hxx>
+#include <TopTools_ShapeMapHasher.hxx>
+
+#include <atomic>
+#include <mutex>
+#include <optional>
+
+namespace {
+
+// Boolean pre-check state. Bounding boxes are cached per shape (TShape and
+// location) so repeated operations on the same cutters and targets, as in
+// layout-driven flows, compute each box once.
+constexpr int BOX_CACHE_LIMIT = 4096;
+
+std::mutex boxCacheMutex;
+NCollection_DataMap<TopoDS_Shape, Bnd_Box, TopTools_ShapeMapHasher> boxCache;
+
+std::atomic<size_t> unionCalls(0), unionSkipped(0);
+std::atomic<size_t> intersectCalls(0), intersectSkipped(0);
+std::atomic<size_t> subtractCalls(0), subtractSkipped(0);
+std::atomic<size_t> unionAnalytic(0), intersectAnalytic(0), subtractAnalytic(0);
+
+Bnd_Box cachedBoundingBox(const TopoDS_Shape& shape) {
+    {
+        std::lock_guard<std::mutex> lock(boxCacheMutex);
+        Bnd_Box box;
+        if (boxCache.Find(shape, box)) {
+            return box;
+        }
+    }
+    
+    // Computed outside the lock; a concurrent miss on the same shape just
+    // binds the same box twice
+    Bnd_Box box;
+    BRepBndLib::Add(shape, box, false);
+    
+    std::lock_guard<std::mutex> lock(boxCacheMutex);
+    if (boxCache.Extent() >= BOX_CACHE_LIMIT) {
+        // The cache holds the shapes alive; drop it rather than grow unbounded
+        boxCache.Clear();
+    }
+    boxCache.Bind(shape, box);
+    return box;
+}
+
+// True when the boxes of both shapes, enlarged by the fuzzy value the
+// boolean would use, do not touch. The kernel would then find no
+// interference, so the result is known without running it.
+bool boxesDisjoint(const TopoDS_Shape& shape1, const TopoDS_Shape& shape2, double fuzzy) {
+    if (shape1.IsNull() || shape2.IsNull()) {
+        return false;
+    }
+    try {
+        Bnd_Box box1 = cachedBoundingBox(shape1);
+        Bnd_Box box2 = cachedBoundingBox(shape2);
+        if (box1.IsVoid() || box2.IsVoid()) {
+            return false;
+        }
+        box1.Enlarge(fuzzy);
+        box2.Enlarge(fuzzy);
+        return box1.IsOut(box2);
+    } catch (const Standard_Failure&) {
+        // Let the full boolean handle (and report) problematic input
+        return false;
+    }
+}
+
+// Looks the operation up in the persistent result cache when it is enabled.
+// key is set whenever the result should be stored after computing it.
+bool findCachedResult(BooleanResultCache::Operation operation, const TopoDS_Shape& shape1,
+                      const TopoDS_Shape& shape2, double fuzzy,
+                      std::optional<BooleanResultCache::Key>& key, TopoDS_Shape& result) {
+    BooleanResultCache& cache = BooleanResultCache::instance();
+    if (!cache.isEnabled()) {
+        return false;
+    }
+    try {
+        key = BooleanResultCache::makeKey(operation, shape1, shape2, fuzzy);
+    } catch (const Standard_Failure&) {
+        // Operands that can't be serialized are simply not cached
+        return false;
+    }
+    return cache.tryGet(*key, result);
+}
+
+void storeCachedResult(const std::optional<BooleanResultCache::Key>& key, const TopoDS_Shape& result) {
+    if (key) {
+        BooleanResultCache::instance().put(*key, result);
+    }
+}
+
+} // namespace
 
 // Basic primitive creation
 TopoDS_Solid GeometryBuilder::createBox(const gp_Pnt& corner, const Dimensions3D& dimensions) {
@@ -264,6 +364,30 @@ TopoDS_Solid GeometryBuilder::extrudeProfile(const Profile2D& profile, const gp_
 
 // Boolean operations
 TopoDS_Shape GeometryBuilder::unionShapes(const TopoDS_Shape& shape1, const TopoDS_Shape& shape2) {
+    unionCalls++;
+    if (boxesDisjoint(shape1, shape2, 5e-9)) {
+        // Disjoint fuse: both operands side by side, as the kernel would return
+        unionSkipped++;
+        TopoDS_Compound compound;
+        BRep_Builder builder;
+        builder.MakeCompound(compound);
+        builder.Add(compound, shape1);
+        builder.Add(compound, shape2);
+        return compound;
+    }
+    
+    TopoDS_Shape analytic;
+    if (BoxBooleanEngine::perform(BoxBooleanOp::Union, {shape1, shape2}, analytic)) {
+        unionAnalytic++;
+        return analytic;
+    }
+    
+    std::optional<BooleanResultCache::Key> cacheKey;
+    TopoDS_Shape cached;
+    if (findCachedResult(BooleanResultCache::Operation::Fuse, shape1, shape2, 5e-9, cacheKey, cached)) {
+        return cached;
+    }
+    
     try {
         BRepAlgoAPI_Fuse fuseMaker(shape1, shape2);
         fuseMaker.SetFuzzyValue(5e-9);
@@ -275,6 +399,7 @@ TopoDS_Shape GeometryBuilder::unionShapes(const TopoDS_Shape& shape1, const Topo
             throw std::runtime_error("Failed to perform union operation");
         }
 
+        storeCachedResult(cacheKey, fuseMaker.Shape());
         return fuseMaker.Shape();
     } catch (const Standard_Failure& e) {
         const char* msg = e.GetMessageString();
@@ -285,6 +410,27 @@ TopoDS_Shape GeometryBuilder::unionShapes(const TopoDS_Shape& shape1, const Topo
 }
 
 TopoDS_Shape GeometryBuilder::intersectShapes(const TopoDS_Shape& shape1, const TopoDS_Shape& shape2) {
+    intersectCalls++;
+    if (boxesDisjoint(shape1, shape2, 5e-9)) {
+        // Disjoint common: empty result
+        intersectSkipped++;
+        TopoDS_Compound empty;
+        BRep_Builder().MakeCompound(empty);
+        return empty;
+    }
+    
+    TopoDS_Shape analytic;
+    if (BoxBooleanEngine::perform(BoxBooleanOp::Common, {shape1, shape2}, analytic)) {
+        intersectAnalytic++;
+        return analytic;
+    }
+    
+    std::optional<BooleanResultCache::Key> cacheKey;
+    TopoDS_Shape cached;
+    if (findCachedResult(BooleanResultCache::Operation::Common, shape1, shape2, 5e-9, cacheKey, cached)) {
+        return cached;
+    }
+    
     try {
         BRepAlgoAPI_Common commonMaker(shape1, shape2);
         commonMaker.SetFuzzyValue(5e-9);
@@ -296,6 +442,7 @@ TopoDS_Shape GeometryBuilder::intersectShapes(const TopoDS_Shape& shape1, const
             throw std::runtime_error("Failed to perform intersection operation");
         }
 
+        storeCachedResult(cacheKey, commonMaker.Shape());
         return commonMaker.Shape();
     } catch (const Standard_Failure& e) {
         const char* msg = e.GetMessageString();
@@ -306,6 +453,29 @@ TopoDS_Shape GeometryBuilder::intersectShapes(const TopoDS_Shape& shape1, const
 }
 
 TopoDS_Shape GeometryBuilder::subtractShapes(const TopoDS_Shape& shape1, const TopoDS_Shape& shape2) {
+    subtractCalls++;
+    // Checked against the larger fuzzy value of the retry
+    if (boxesDisjoint(shape1, shape2, 5e-8)) {
+        // Disjoint cut: the target is unchanged
+        subtractSkipped++;
+        return shape1;
+    }
+    
+    // Box operands are cut exactly, without the retry and repair below
+    TopoDS_Shape analytic;
+    if (BoxBooleanEngine::perform(BoxBooleanOp::Cut, {shape1, shape2}, analytic)) {
+        subtractAnalytic++;
+        return analytic;
+    }
+    
+    // Keyed on the first attempt's fuzzy value: whichever attempt succeeds
+    // is the result of this call for these operands
+    std::optional<BooleanResultCache::Key> cacheKey;
+    TopoDS_Shape cached;
+    if (findCachedResult(BooleanResultCache::Operation::Cut, shape1, shape2, 5e-9, cacheKey, cached)) {
+        return cached;
+    }
+    
     try {
         // First attempt
         {
@@ -315,6 +485,7 @@ TopoDS_Shape GeometryBuilder::subtractShapes(const TopoDS_Shape& shape1, const T
             cutMaker.SetRunParallel(true);
             cutMaker.Build();
             if (cutMaker.IsDone()) {
+                storeCachedResult(cacheKey, cutMaker.Shape());
                 return cutMaker.Shape();
             }
         }
@@ -328,6 +499,7 @@ TopoDS_Shape GeometryBuilder::subtractShapes(const TopoDS_Shape& shape1, const T
             cutMaker2.SetRunParallel(true);
             cutMaker2.Build();
             if (cutMaker2.IsDone()) {
+                storeCachedResult(cacheKey, cutMaker2.Shape());
                 return cutMaker2.Shape();
             }
             throw std::runtime_error("Failed to perform subtraction operation (after retry)");
@@ -340,6 +512,179 @@ TopoDS_Shape GeometryBuilder::subtractShapes(const TopoDS_Shape& shape1, const T
     }
 }
 
+BooleanStats GeometryBuilder::getBooleanStats() {
+    BooleanStats stats;
+    stats.unionCalls = unionCalls.load();
+    stats.unionSkipped = unionSkipped.load();
+    stats.intersectCalls = intersectCalls.load();
+    stats.intersectSkipped = intersectSkipped.load();
+    stats.subtractCalls = subtractCalls.load();
+    stats.subtractSkipped = subtractSkipped.load();
+    stats.unionAnalytic = unionAnalytic.load();
+    stats.intersectAnalytic = intersectAnalytic.load();
+    stats.subtractAnalytic = subtractAnalytic.load();
+    return stats;
+}
+
+void GeometryBuilder::resetBooleanStats() {
+    unionCalls = 0;
+    unionSkipped = 0;
+    intersectCalls = 0;
+    intersectSkipped = 0;
+    subtractCalls = 0;
+    subtractSkipped = 0;
+    unionAnalytic = 0;
+    intersectAnalytic = 0;
+    subtractAnalytic = 0;
+}
+
+void GeometryBuilder::clearBoundingBoxCache() {
+    {
+        std::lock_guard<std::mutex> lock(boxCacheMutex);
+        boxCache.Clear();
+    }
+    BoxBooleanEngine::clearCache();
+}
+
+// Multi-shape boolean operations. All arguments go through one general fuse
+// run (one intersection pass, parallel), instead of a pairwise chain that
+// re-intersects the growing accumulated result at every step.
+TopoDS_Shape GeometryBuilder::unionMultipleShapes(const std::vector<TopoDS_Shape>& shapes) {
+    if (shapes.empty()) {
+        throw std::invalid_argument("unionMultipleShapes requires at least one shape");
+    }
+    if (shapes.size() == 1) {
+        return shapes.front();
+    }
+    
+    TopoDS_Shape analytic;
+    if (BoxBooleanEngine::perform(BoxBooleanOp::Union, shapes, analytic)) {
+        return analytic;
+    }
+    
+    try {
+        // Fuse is the general fuse followed by removal of the internal
+        // splits; every argument is intersected with every other in one run
+        TopTools_ListOfShape objects;
+        TopTools_ListOfShape tools;
+        objects.Append(shapes.front());
+        for (size_t i = 1; i < shapes.size(); i++) {
+            tools.Append(shapes[i]);
+        }
+        
+        BRepAlgoAPI_Fuse fuseMaker;
+        fuseMaker.SetArguments(objects);
+        fuseMaker.SetTools(tools);
+        fuseMaker.SetFuzzyValue(5e-9);
+        fuseMaker.SetNonDestructive(true);
+        fuseMaker.SetRunParallel(true);
+        fuseMaker.Build();
+        
+        if (!fuseMaker.IsDone()) {
+            throw std::runtime_error("Failed to perform multi-shape union operation");
+        }
+        
+        return fuseMaker.Shape();
+    } catch (const std::runtime_error&) {
+        throw;
+    } catch (const Standard_Failure& e) {
+        const char* msg = e.GetMessageString();
+        throw std::runtime_error(std::string("OpenCASCADE error during multi-shape union (fuse): ") + (msg ? msg : "<no message>"));
+    } catch (...) {
+        throw std::runtime_error("OpenCASCADE error during multi-shape union (fuse)");
+    }
+}
+
+TopoDS_Shape GeometryBuilder::intersectMultipleShapes(const std::vector<TopoDS_Shape>& shapes) {
+    if (shapes.empty()) {
+        throw std::invalid_argument("intersectMultipleShapes requires at least one shape");
+    }
+    if (shapes.size() == 1) {
+        return shapes.front();
+    }
+    
+    TopoDS_Shape analytic;
+    if (BoxBooleanEngine::perform(BoxBooleanOp::Common, shapes, analytic)) {
+        return analytic;
+    }
+    
+    std::vector<TopoDS_Shape> pieces;
+    try {
+        // A boolean Common with several tools keeps what lies inside any
+        // tool, not inside all of them. Instead split every argument against
+        // all others with the general fuse: the pieces where arguments
+        // overlap are shared, so the n-way intersection is the set of result
+        // solids that are an image of every argument.
+        TopTools_ListOfShape arguments;
+        for (const TopoDS_Shape& shape : shapes) {
+            arguments.Append(shape);
+        }
+        
+        BRepAlgoAPI_BuilderAlgo builder;
+        builder.SetArguments(arguments);
+        builder.SetFuzzyValue(5e-9);
+        builder.SetNonDestructive(true);
+        builder.SetRunParallel(true);
+        builder.Build();
+        
+        if (!builder.IsDone()) {
+            throw std::runtime_error("Failed to perform multi-shape intersection operation");
+        }
+        
+        std::vector<TopTools_MapOfShape> images(shapes.size());
+        for (size_t i = 0; i < shapes.size(); i++) {
+            for (TopExp_Explorer exp(shapes[i], TopAbs_SOLID); exp.More(); exp.Next()) {
+                const TopTools_ListOfShape& modified = builder.Modified(exp.Current());
+                if (modified.IsEmpty()) {
+                    // Untouched by the others: the solid itself is in the result
+                    images[i].Add(exp.Current());
+                }
+                for (TopTools_ListIteratorOfListOfShape it(modified); it.More(); it.Next()) {
+                    images[i].Add(it.Value());
+                }
+            }
+            if (images[i].Extent() == 0) {
+                throw std::invalid_argument("intersectMultipleShapes expects solid arguments");
+            }
+        }
+        
+        // Walk the result so the pieces come out in a deterministic order
+        for (TopExp_Explorer exp(builder.Shape(), TopAbs_SOLID); exp.More(); exp.Next()) {
+            bool inAll = true;
+            for (const TopTools_MapOfShape& image : images) {
+                if (!image.Contains(exp.Current())) {
+                    inAll = false;
+                    break;
+                }
+            }
+            if (inAll) {
+                pieces.push_back(exp.Current());
+            }
+        }
+    } catch (const std::runtime_error&) {
+        throw;
+    } catch (const std::invalid_argument&) {
+        throw;
+    } catch (const Standard_Failure& e) {
+        const char* msg = e.GetMessageString();
+        throw std::runtime_error(std::string("OpenCASCADE error during multi-shape intersection: ") + (msg ? msg : "<no message>"));
+    } catch (...) {
+        throw std::runtime_error("OpenCASCADE error during multi-shape intersection");
+    }
+    
+    if (pieces.empty()) {
+        // Same as a pairwise Common of disjoint shapes: an empty compound
+        TopoDS_Compound empty;
+        BRep_Builder().MakeCompound(empty);
+        return empty;
+    }
+    if (pieces.size() == 1) {
+        return pieces.front();
+    }
+    // Pieces share the faces they were split along; fuse them into one shape
+    return unionMultipleShapes(pieces);
+}
+
 // Semiconductor-specific geometries
 TopoDS_Solid GeometryBuilder::createMOSFET(double gateLength, double gateWidth, double gateThickness,
                                          double sourceLength, double drainLength, 
@@ -364,8 +709,7 @@ TopoDS_Solid GeometryBuilder::createMOSFET(double gateLength, double gateWidth,
     );
     
     // Combine all parts
-    TopoDS_Shape combined = unionShapes(substrate, oxide);
-    combined = unionShapes(combined, gate);
+    TopoDS_Shape combined = unionMultipleShapes({substrate, oxide, gate});
     
     // Extract solid from the combined shape
     TopoDS_Solid result;
@@ -0,0 +1,143 @@
+// MeshBVH.cpp
+#include "MeshBVH.h"
+#include "ParallelUtils.h"
+
+#include <algorithm>
+
+namespace {
+const std::int32_t kLeafSize = 4;
+}
+
+void MeshBVH::build(const double* boxes, size_t primitiveCount) {
+    m_nodes.clear();
+    m_primitives.resize(primitiveCount);
+    if (primitiveCount == 0) return;
+
+    std::vector<double> centers(3 * primitiveCount);
+    parallelForChunks(primitiveCount, 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            m_primitives[i] = static_cast<std::int32_t>(i);
+            for (int axis = 0; axis < 3; axis++) {
+                centers[3 * i + axis] = 0.5 * (boxes[6 * i + axis] + boxes[6 * i + 3 + axis]);
+            }
+        }
+    });
+
+    // A median-split tree with leaves of up to kLeafSize has fewer than
+    // 2 * primitiveCount / kLeafSize + 1 nodes
+    m_nodes.reserve(2 * primitiveCount / kLeafSize + 1);
+    buildRecursive(boxes, centers, 0, static_cast<std::int32_t>(primitiveCount));
+}
+
+std::int32_t MeshBVH::buildRecursive(const double* boxes, const std::vector<double>& centers,
+                                     std::int32_t begin, std::int32_t end) {
+    const std::int32_t nodeIndex = static_cast<std::int32_t>(m_nodes.size());
+    m_nodes.push_back(Node());
+
+    Node node;
+    double cmin[3], cmax[3];
+    for (int axis = 0; axis < 3; axis++) {
+        node.bmin[axis] = cmin[axis] = std::numeric_limits<double>::max();
+        node.bmax[axis] = cmax[axis] = -std::numeric_limits<double>::max();
+    }
+    for (std::int32_t k = begin; k < end; k++) {
+        const std::int32_t primitive = m_primitives[k];
+        for (int axis = 0; axis < 3; axis++) {
+            node.bmin[axis] = std::min(node.bmin[axis], boxes[6 * primitive + axis]);
+            node.bmax[axis] = std::max(node.bmax[axis], boxes[6 * primitive + 3 + axis]);
+            cmin[axis] = std::min(cmin[axis], centers[3 * primitive + axis]);
+            cmax[axis] = std::max(cmax[axis], centers[3 * primitive + axis]);
+        }
+    }
+
+    if (end - begin <= kLeafSize) {
+        node.start = begin;
+        node.count = end - begin;
+        m_nodes[nodeIndex] = node;
+        return nodeIndex;
+    }
+
+    // Split at the median centre along the axis with the widest centre spread
+    int splitAxis = 0;
+    for (int axis = 1; axis < 3; axis++) {
+        if (cmax[axis] - cmin[axis] > cmax[splitAxis] - cmin[splitAxis]) splitAxis = axis;
+    }
+    const std::int32_t middle = begin + (end - begin) / 2;
+    std::nth_element(m_primitives.begin() + begin, m_primitives.begin() + middle,
+                     m_primitives.begin() + end,
+                     [&](std::int32_t a, std::int32_t b) {
+                         const double ca = centers[3 * a + splitAxis];
+                         const double cb = centers[3 * b + splitAxis];
+                         return ca < cb || (ca == cb && a < b);
+                     });
+
+    buildRecursive(boxes, centers, begin, middle);
+    node.start = buildRecursive(boxes, centers, middle, end);
+    node.count = 0;
+    m_nodes[nodeIndex] = node;
+    return nodeIndex;
+}
+
+double MeshBVH::closestPointOnTriangle(const double* p, const double* a, const double* b,
+                                       const double* c, double* closest) {
+    // Voronoi-region classification (Ericson, Real-Time Collision Detection, 5.1.5)
+    double ab[3], ac[3], ap[3];
+    for (int i = 0; i < 3; i++) {
+        ab[i] = b[i] - a[i];
+        ac[i] = c[i] - a[i];
+        ap[i] = p[i] - a[i];
+    }
+    auto dot = [](const double* u, const double* v) { return u[0] * v[0] + u[1] * v[1] + u[2] * v[2]; };
+    auto finish = [&](double u, double v, double w) {
+        double d2 = 0.0;
+        for (int i = 0; i < 3; i++) {
+            closest[i] = u * a[i] + v * b[i] + w * c[i];
+            const double d = p[i] - closest[i];
+            d2 += d * d;
+        }
+        return d2;
+    };
+
+    const double d1 = dot(ab, ap);
+    const double d2 = dot(ac, ap);
+    if (d1 <= 0.0 && d2 <= 0.0) return finish(1.0, 0.0, 0.0);
+
+    double bp[3];
+    for (int i = 0; i < 3; i++) bp[i] = p[i] - b[i];
+    const double d3 = dot(ab, bp);
+    const double d4 = dot(ac, bp);
+    if (d3 >= 0.0 && d4 <= d3) return finish(0.0, 1.0, 0.0);
+
+    const double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+        const double v = d1 / (d1 - d3);
+        return finish(1.0 - v, v, 0.0);
+    }
+
+    double cp[3];
+    for (int i = 0; i < 3; i++) cp[i] = p[i] - c[i];
+    const double d5 = dot(ab, cp);
+    const double d6 = dot(ac, cp);
+    if (d6 >= 0.0 && d5 <= d6) return finish(0.0, 0.0, 1.0);
+
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+        const double w = d2 / (d2 - d6);
+        return finish(1.0 - w, 0.0, w);
+    }
+
+    const double va = d3 * d6 - d5 * d4;
+    if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+        const double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        return finish(0.0, 1.0 - w, w);
+    }
+
+    const double denom = va + vb + vc;
+    if (denom == 0.0) {
+        // Degenerate triangle that slipped past the edge tests: fall back to vertex a
+        return finish(1.0, 0.0, 0.0);
+    }
+    const double v = vb / denom;
+    const double w = vc / denom;
+    return finish(1.0 - v - w, v, w);
+}
@@ -0,0 +1,906 @@
+// MeshFileReader.cpp
+#include "MeshFileReader.h"
+#include "ParallelUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MESH_FILE_READER_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define MESH_FILE_READER_HAVE_MMAP 0
+#endif
+
+MappedFile::MappedFile(const std::string& filename) {
+#if MESH_FILE_READER_HAVE_MMAP
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file for reading: " + filename);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat file: " + filename);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ > 0) {
+        void* address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            // Chunks are parsed concurrently, so ask for the whole file up front
+            ::madvise(address, size_, MADV_WILLNEED);
+            data_ = static_cast<const char*>(address);
+            mapped_ = true;
+        }
+    }
+    ::close(fd);
+    if (mapped_ || size_ == 0) return;
+#endif
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file for reading: " + filename);
+    }
+    file.seekg(0, std::ios::end);
+    size_ = static_cast<size_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+    buffer_.resize(size_);
+    if (size_ > 0 && !file.read(buffer_.data(), static_cast<std::streamsize>(size_))) {
+        throw std::runtime_error("Cannot read file: " + filename);
+    }
+    data_ = buffer_.data();
+}
+
+MappedFile::~MappedFile() {
+#if MESH_FILE_READER_HAVE_MMAP
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+namespace {
+
+const size_t kChunkBytes = size_t(1) << 20;
+const size_t kMaxIndex = static_cast<size_t>(std::numeric_limits<std::int32_t>::max());
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+}
+
+bool hostIsBigEndian() {
+    const std::uint16_t one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first == 0;
+}
+
+std::string upper(std::string_view text) {
+    std::string result(text);
+    for (char& c : result) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    return result;
+}
+
+bool equalsNoCase(const char* first, const char* last, const char* word) {
+    for (; first != last; ++first, ++word) {
+        if (*word == '\0' || std::tolower(static_cast<unsigned char>(*first)) != *word) return false;
+    }
+    return *word == '\0';
+}
+
+// Parse a whole token as a number
+template <typename T>
+bool parseNumber(const char* first, const char* last, T& value) {
+    if (first != last && *first == '+') ++first;
+    if constexpr (std::is_floating_point_v<T>) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        const auto result = std::from_chars(first, last, value);
+        return result.ec == std::errc() && result.ptr == last;
+#else
+        // Floating-point from_chars is unavailable before GCC 11
+        char buffer[128];
+        const size_t length = static_cast<size_t>(last - first);
+        if (length == 0 || length >= sizeof(buffer)) return false;
+        std::memcpy(buffer, first, length);
+        buffer[length] = '\0';
+        char* end = nullptr;
+        value = static_cast<T>(std::strtod(buffer, &end));
+        return end == buffer + length;
+#endif
+    } else {
+        const auto result = std::from_chars(first, last, value);
+        return result.ec == std::errc() && result.ptr == last;
+    }
+}
+
+// Call fn(tokenBegin, tokenEnd) for every token starting in [begin, end);
+// tokens may run on up to limit. fn returns false to stop early.
+template <typename Fn>
+void forEachToken(const char* begin, const char* end, const char* limit, Fn&& fn) {
+    const char* p = begin;
+    while (true) {
+        while (p < end && isSpace(*p)) ++p;
+        if (p >= end) return;
+        const char* tokenEnd = p;
+        while (tokenEnd < limit && !isSpace(*tokenEnd)) ++tokenEnd;
+        if (!fn(p, tokenEnd)) return;
+        p = tokenEnd;
+    }
+}
+
+// Chunk boundaries over [begin, end), each moved forward onto whitespace so
+// that no token straddles two chunks
+std::vector<const char*> splitAtWhitespace(const char* begin, const char* end) {
+    std::vector<const char*> bounds{begin};
+    const size_t length = static_cast<size_t>(end - begin);
+    for (size_t offset = kChunkBytes; offset < length; offset += kChunkBytes) {
+        const char* p = std::max(begin + offset, bounds.back());
+        while (p < end && !isSpace(*p)) ++p;
+        if (p >= end) break;
+        if (p > bounds.back()) bounds.push_back(p);
+    }
+    bounds.push_back(end);
+    return bounds;
+}
+
+// Whitespace-separated tokens of an ASCII region, split into chunks that
+// know the index of their first token, so any run of tokens can be located
+// and parsed in parallel
+class TokenChunks {
+public:
+    TokenChunks(const char* begin, const char* end)
+        : m_end(end), m_bounds(splitAtWhitespace(begin, end)) {
+        const size_t chunkCount = m_bounds.size() - 1;
+        m_firstToken.assign(chunkCount + 1, 0);
+        parallelForChunks(chunkCount, 1, [&](size_t first, size_t last) {
+            for (size_t j = first; j < last; j++) {
+                size_t count = 0;
+                forEachToken(m_bounds[j], m_bounds[j + 1], m_end, [&](const char*, const char*) {
+                    count++;
+                    return true;
+                });
+                m_firstToken[j + 1] = count;
+            }
+        });
+        for (size_t j = 0; j < chunkCount; j++) {
+            m_firstToken[j + 1] += m_firstToken[j];
+        }
+    }
+
+    size_t tokenCount() const { return m_firstToken.back(); }
+
+    // Index of the first token starting at or after pos
+    size_t tokenIndexAt(const char* pos) const {
+        const size_t j = std::upper_bound(m_bounds.begin(), m_bounds.end() - 1, pos) - m_bounds.begin() - 1;
+        size_t index = m_firstToken[j];
+        forEachToken(m_bounds[j], pos, m_end, [&](const char*, const char*) {
+            index++;
+            return true;
+        });
+        return index;
+    }
+
+    // Start of the given token, or the end of the region past the last one
+    const char* tokenStart(size_t token) const {
+        if (token >= tokenCount()) return m_end;
+        const size_t j = chunkOfToken(token);
+        size_t index = m_firstToken[j];
+        const char* start = m_end;
+        forEachToken(m_bounds[j], m_bounds[j + 1], m_end, [&](const char* tokenBegin, const char*) {
+            if (index++ == token) {
+                start = tokenBegin;
+                return false;
+            }
+            return true;
+        });
+        return start;
+    }
+
+    // Parse tokens [firstToken, firstToken + count) into out
+    template <typename T>
+    bool parse(size_t firstToken, size_t count, T* out) const {
+        if (count == 0) return true;
+        if (firstToken + count > tokenCount()) return false;
+        const size_t lastToken = firstToken + count;
+        const size_t firstChunk = chunkOfToken(firstToken);
+        const size_t lastChunk = chunkOfToken(lastToken - 1);
+
+        std::atomic<bool> ok(true);
+        parallelForChunks(lastChunk - firstChunk + 1, 1, [&](size_t first, size_t last) {
+            for (size_t j = firstChunk + first; j < firstChunk + last; j++) {
+                size_t index = m_firstToken[j];
+                forEachToken(m_bounds[j], m_bounds[j + 1], m_end, [&](const char* tokenBegin, const char* tokenEnd) {
+                    if (index >= lastToken) return false;
+                    if (index >= firstToken && !parseNumber(tokenBegin, tokenEnd, out[index - firstToken])) {
+                        ok.store(false, std::memory_order_relaxed);
+                        return false;
+                    }
+                    index++;
+                    return true;
+                });
+            }
+        });
+        return ok.load();
+    }
+
+private:
+    size_t chunkOfToken(size_t token) const {
+        return std::upper_bound(m_firstToken.begin(), m_firstToken.end(), token) - m_firstToken.begin() - 1;
+    }
+
+    const char* m_end;
+    std::vector<const char*> m_bounds;
+    std::vector<size_t> m_firstToken;  // Token index at the start of each chunk, plus the total
+};
+
+// Sequential reader for keywords and header values
+struct Cursor {
+    const char* pos;
+    const char* end;
+
+    bool atEnd() {
+        while (pos < end && isSpace(*pos)) ++pos;
+        return pos >= end;
+    }
+
+    std::string_view next() {
+        while (pos < end && isSpace(*pos)) ++pos;
+        const char* start = pos;
+        while (pos < end && !isSpace(*pos)) ++pos;
+        return std::string_view(start, static_cast<size_t>(pos - start));
+    }
+
+    std::string_view peek() {
+        const char* saved = pos;
+        const std::string_view token = next();
+        pos = saved;
+        return token;
+    }
+
+    std::string_view line() {
+        const char* start = pos;
+        while (pos < end && *pos != '\n') ++pos;
+        std::string_view text(start, static_cast<size_t>(pos - start));
+        if (pos < end) ++pos;
+        if (!text.empty() && text.back() == '\r') text.remove_suffix(1);
+        return text;
+    }
+
+    void skipLine() { line(); }
+
+    template <typename T>
+    T number(const char* what) {
+        const std::string_view token = next();
+        T value;
+        if (!parseNumber(token.data(), token.data() + token.size(), value)) {
+            throw std::runtime_error(std::string("Invalid ") + what + ": '" + std::string(token) + "'");
+        }
+        return value;
+    }
+};
+
+// Decode count fixed-size values, byte-swapping when the file's byte order
+// differs from the host's
+template <typename Stored, typename Out>
+void decodeValues(const char* src, size_t count, bool swap, Out* out) {
+    parallelForChunks(count, 65536, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            unsigned char bytes[sizeof(Stored)];
+            std::memcpy(bytes, src + i * sizeof(Stored), sizeof(Stored));
+            if (swap) std::reverse(bytes, bytes + sizeof(Stored));
+            Stored value;
+            std::memcpy(&value, bytes, sizeof(Stored));
+            out[i] = static_cast<Out>(value);
+        }
+    });
+}
+
+enum class ValueType { Bit, UInt8, Int8, UInt16, Int16, UInt32, Int32, UInt64, Int64, Float32, Float64 };
+
+ValueType parseValueType(std::string_view name) {
+    const std::string type = upper(name);
+    if (type == "BIT") return ValueType::Bit;
+    if (type == "UNSIGNED_CHAR") return ValueType::UInt8;
+    if (type == "CHAR") return ValueType::Int8;
+    if (type == "UNSIGNED_SHORT") return ValueType::UInt16;
+    if (type == "SHORT") return ValueType::Int16;
+    if (type == "UNSIGNED_INT" || type == "VTKTYPEUINT32") return ValueType::UInt32;
+    if (type == "INT" || type == "VTKTYPEINT32" || type == "VTKIDTYPE") return ValueType::Int32;
+    if (type == "UNSIGNED_LONG" || type == "VTKTYPEUINT64") return ValueType::UInt64;
+    if (type == "LONG" || type == "VTKTYPEINT64") return ValueType::Int64;
+    if (type == "FLOAT") return ValueType::Float32;
+    if (type == "DOUBLE") return ValueType::Float64;
+    throw std::runtime_error("Unsupported VTK data type: " + std::string(name));
+}
+
+size_t valueBytes(ValueType type, size_t count) {
+    switch (type) {
+        case ValueType::Bit: return (count + 7) / 8;
+        case ValueType::UInt8: case ValueType::Int8: return count;
+        case ValueType::UInt16: case ValueType::Int16: return 2 * count;
+        case ValueType::UInt32: case ValueType::Int32: case ValueType::Float32: return 4 * count;
+        default: return 8 * count;
+    }
+}
+
+// VTK cell types produced by the legacy formats that carry surface triangles
+const int kVtkVertex = 1;
+const int kVtkLine = 3;
+const int kVtkTriangleStrip = 6;
+const int kVtkPolygon = 7;
+const int kVtkPixel = 8;
+const int kVtkQuad = 9;
+const int kVtkTriangle = 5;
+
+int trianglesInCell(int type, std::int32_t size) {
+    switch (type) {
+        case kVtkTriangle: return size == 3 ? 1 : 0;
+        case kVtkPixel:
+        case kVtkQuad: return size == 4 ? 2 : 0;
+        case kVtkPolygon:
+        case kVtkTriangleStrip: return size >= 3 ? size - 2 : 0;
+        default: return 0;
+    }
+}
+
+// Legacy VTK parser. The header and keywords are read sequentially; bulk
+// arrays are parsed through TokenChunks (ASCII) or decoded in place (BINARY,
+// big-endian).
+class VTKParser {
+public:
+    VTKParser(const MappedFile& file, const std::string& filename)
+        : m_cursor{file.data(), file.data() + file.size()}, m_filename(filename) {}
+
+    ImportedMesh parse() {
+        readHeader();
+        while (!m_cursor.atEnd()) {
+            readSection(upper(m_cursor.next()));
+        }
+        return assemble();
+    }
+
+private:
+    void readHeader() {
+        const std::string_view magic = m_cursor.line();
+        const std::string_view prefix = "# vtk DataFile Version";
+        if (magic.substr(0, prefix.size()) != prefix) {
+            throw std::runtime_error("Not a legacy VTK file: " + m_filename);
+        }
+        const std::string_view version = magic.substr(prefix.size());
+        const size_t digit = version.find_first_not_of(" \t");
+        if (digit != std::string_view::npos) {
+            std::from_chars(version.data() + digit, version.data() + version.size(), m_version);
+        }
+
+        m_cursor.skipLine();  // title
+        const std::string encoding = upper(m_cursor.next());
+        if (encoding == "BINARY") {
+            m_binary = true;
+        } else if (encoding != "ASCII") {
+            throw std::runtime_error("Unknown VTK encoding: " + encoding);
+        }
+        if (!m_binary) {
+            m_tokens = std::make_unique<TokenChunks>(m_cursor.pos, m_cursor.end);
+        }
+
+        if (upper(m_cursor.next()) != "DATASET") {
+            throw std::runtime_error("Missing DATASET in VTK file: " + m_filename);
+        }
+        const std::string dataset = upper(m_cursor.next());
+        if (dataset == "POLYDATA") {
+            m_polyData = true;
+        } else if (dataset != "UNSTRUCTURED_GRID") {
+            throw std::runtime_error("Unsupported VTK dataset type: " + dataset);
+        }
+    }
+
+    void readSection(const std::string& keyword) {
+        if (keyword == "POINTS") {
+            readPoints();
+        } else if (keyword == "CELLS" && !m_polyData) {
+            readCells(-1);
+        } else if (keyword == "POLYGONS" && m_polyData) {
+            readCells(kVtkPolygon);
+        } else if (keyword == "TRIANGLE_STRIPS" && m_polyData) {
+            readCells(kVtkTriangleStrip);
+        } else if (keyword == "VERTICES" && m_polyData) {
+            readCells(kVtkVertex);
+        } else if (keyword == "LINES" && m_polyData) {
+            readCells(kVtkLine);
+        } else if (keyword == "CELL_TYPES" && !m_polyData) {
+            readCellTypes();
+        } else if (keyword == "CELL_DATA") {
+            m_attributesOnCells = true;
+            m_attributeCount = m_cursor.number<size_t>("CELL_DATA count");
+        } else if (keyword == "POINT_DATA") {
+            m_attributesOnCells = false;
+            m_attributeCount = m_cursor.number<size_t>("POINT_DATA count");
+        } else if (keyword == "FIELD") {
+            readField();
+        } else if (keyword == "METADATA") {
+            skipMetadata();
+        } else {
+            readAttribute(keyword);
+        }
+    }
+
+    void readPoints() {
+        const size_t count = m_cursor.number<size_t>("POINTS count");
+        const ValueType type = parseValueType(m_cursor.next());
+        if (count > kMaxIndex) {
+            throw std::runtime_error("VTK point count exceeds 32-bit index range");
+        }
+        std::vector<double> coordinates(3 * count);
+        readValues(3 * count, type, coordinates.data());
+
+        m_nodes.resize(count);
+        parallelForChunks(count, 65536, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                m_nodes.x[i] = coordinates[3 * i];
+                m_nodes.y[i] = coordinates[3 * i + 1];
+                m_nodes.z[i] = coordinates[3 * i + 2];
+            }
+        });
+    }
+
+    // Append a cell block; polyType is the cell type of a POLYDATA block,
+    // -1 for unstructured grids whose types follow in CELL_TYPES
+    void readCells(int polyType) {
+        const size_t first = m_cursor.number<size_t>("cell count");
+        const size_t second = m_cursor.number<size_t>("cell list size");
+        const size_t base = m_connectivity.size();
+
+        if (m_version >= 5) {
+            // OFFSETS <type> with first entries, then CONNECTIVITY <type> with second entries
+            if (upper(m_cursor.next()) != "OFFSETS") {
+                throw std::runtime_error("Expected OFFSETS in VTK cell block");
+            }
+            std::vector<std::int64_t> offsets(first);
+            readValues(first, parseValueType(m_cursor.next()), offsets.data());
+            if (upper(m_cursor.next()) != "CONNECTIVITY") {
+                throw std::runtime_error("Expected CONNECTIVITY in VTK cell block");
+            }
+            m_connectivity.resize(base + second);
+            readValues(second, parseValueType(m_cursor.next()), m_connectivity.data() + base);
+
+            for (size_t c = 0; c + 1 < first; c++) {
+                if (offsets[c] < 0 || offsets[c + 1] < offsets[c] ||
+                    static_cast<size_t>(offsets[c + 1]) > second) {
+                    throw std::runtime_error("Invalid OFFSETS in VTK cell block");
+                }
+                m_cellStart.push_back(static_cast<std::int64_t>(base) + offsets[c]);
+                m_cellSize.push_back(static_cast<std::int32_t>(offsets[c + 1] - offsets[c]));
+            }
+        } else {
+            // Each cell is its point count followed by the point indices
+            m_connectivity.resize(base + second);
+            readValues(second, ValueType::Int32, m_connectivity.data() + base);
+
+            size_t p = 0;
+            for (size_t c = 0; c < first; c++) {
+                const std::int64_t size = p < second ? m_connectivity[base + p] : -1;
+                if (size < 0 || p + 1 + static_cast<size_t>(size) > second) {
+                    throw std::runtime_error("VTK cell list is shorter than its cell count");
+                }
+                m_cellStart.push_back(static_cast<std::int64_t>(base + p + 1));
+                m_cellSize.push_back(static_cast<std::int32_t>(size));
+                p += 1 + static_cast<size_t>(size);
+            }
+            if (p != second) {
+                throw std::runtime_error("VTK cell list size does not match its cells");
+            }
+        }
+
+        if (polyType >= 0) {
+            m_cellTypes.resize(m_cellStart.size(), static_cast<std::uint8_t>(polyType));
+        }
+    }
+
+    void readCellTypes() {
+        const size_t count = m_cursor.number<size_t>("CELL_TYPES count");
+        std::vector<std::int32_t> types(count);
+        readValues(count, ValueType::Int32, types.data());
+        m_cellTypes.resize(count);
+        for (size_t c = 0; c < count; c++) {
+            m_cellTypes[c] = static_cast<std::uint8_t>(types[c]);
+        }
+    }
+
+    // Dataset attributes; only a single-component FaceID on cells is kept
+    void readAttribute(const std::string& keyword) {
+        const size_t n = m_attributeCount;
+        if (keyword == "SCALARS") {
+            const std::string_view name = m_cursor.next();
+            const ValueType type = parseValueType(m_cursor.next());
+            size_t components = 1;
+            if (upper(m_cursor.peek()) != "LOOKUP_TABLE") {
+                components = m_cursor.number<size_t>("SCALARS component count");
+            }
+            if (upper(m_cursor.next()) != "LOOKUP_TABLE") {
+                throw std::runtime_error("Expected LOOKUP_TABLE after SCALARS");
+            }
+            m_cursor.next();  // table name
+            readOrSkipArray(name, components, n, type);
+        } else if (keyword == "LOOKUP_TABLE") {
+            m_cursor.next();
+            const size_t size = m_cursor.number<size_t>("LOOKUP_TABLE size");
+            skipValues(4 * size, m_binary ? ValueType::UInt8 : ValueType::Float32);
+        } else if (keyword == "COLOR_SCALARS") {
+            m_cursor.next();
+            const size_t components = m_cursor.number<size_t>("COLOR_SCALARS component count");
+            skipValues(components * n, m_binary ? ValueType::UInt8 : ValueType::Float32);
+        } else if (keyword == "VECTORS" || keyword == "NORMALS") {
+            m_cursor.next();
+            skipValues(3 * n, parseValueType(m_cursor.next()));
+        } else if (keyword == "TENSORS") {
+            m_cursor.next();
+            skipValues(9 * n, parseValueType(m_cursor.next()));
+        } else if (keyword == "TENSORS6") {
+            m_cursor.next();
+            skipValues(6 * n, parseValueType(m_cursor.next()));
+        } else if (keyword == "TEXTURE_COORDINATES") {
+            m_cursor.next();
+            const size_t dimension = m_cursor.number<size_t>("TEXTURE_COORDINATES dimension");
+            skipValues(dimension * n, parseValueType(m_cursor.next()));
+        } else if (keyword == "GLOBAL_IDS" || keyword == "PEDIGREE_IDS") {
+            m_cursor.next();
+            skipValues(n, parseValueType(m_cursor.next()));
+        } else {
+            throw std::runtime_error("Unsupported VTK keyword: " + keyword);
+        }
+    }
+
+    void readField() {
+        m_cursor.next();  // field name
+        const size_t arrayCount = m_cursor.number<size_t>("FIELD array count");
+        for (size_t a = 0; a < arrayCount; a++) {
+            const std::string_view name = m_cursor.next();
+            if (upper(name) == "METADATA") {
+                skipMetadata();
+                a--;
+                continue;
+            }
+            const size_t components = m_cursor.number<size_t>("FIELD component count");
+            const size_t tuples = m_cursor.number<size_t>("FIELD tuple count");
+            const ValueType type = parseValueType(m_cursor.next());
+            readOrSkipArray(name, components, tuples, type);
+        }
+    }
+
+    void readOrSkipArray(std::string_view name, size_t components, size_t tuples, ValueType type) {
+        if (m_attributesOnCells && components == 1 && upper(name) == "FACEID") {
+            m_faceIds.resize(tuples);
+            readValues(tuples, type, m_faceIds.data());
+        } else {
+            skipValues(components * tuples, type);
+        }
+    }
+
+    // METADATA blocks end at the first blank line
+    void skipMetadata() {
+        m_cursor.skipLine();
+        while (m_cursor.pos < m_cursor.end) {
+            const std::string_view text = m_cursor.line();
+            if (text.find_first_not_of(" \t") == std::string_view::npos) break;
+        }
+    }
+
+    template <typename Out>
+    void readValues(size_t count, ValueType type, Out* out) {
+        if (!m_binary) {
+            const size_t first = m_tokens->tokenIndexAt(m_cursor.pos);
+            if (!m_tokens->parse(first, count, out)) {
+                throw std::runtime_error("Malformed or truncated numeric data in VTK file: " + m_filename);
+            }
+            m_cursor.pos = m_tokens->tokenStart(first + count);
+            return;
+        }
+
+        // Binary data starts on the line after its section header
+        m_cursor.skipLine();
+        const size_t bytes = valueBytes(type, count);
+        if (bytes > static_cast<size_t>(m_cursor.end - m_cursor.pos)) {
+            throw std::runtime_error("Truncated binary data in VTK file: " + m_filename);
+        }
+        const char* src = m_cursor.pos;
+        const bool swap = !hostIsBigEndian();
+        switch (type) {
+            case ValueType::Bit:
+                for (size_t i = 0; i < count; i++) {
+                    out[i] = static_cast<Out>((static_cast<unsigned char>(src[i / 8]) >> (7 - i % 8)) & 1);
+                }
+                break;
+            case ValueType::UInt8: decodeValues<std::uint8_t>(src, count, swap, out); break;
+            case ValueType::Int8: decodeValues<std::int8_t>(src, count, swap, out); break;
+            case ValueType::UInt16: decodeValues<std::uint16_t>(src, count, swap, out); break;
+            case ValueType::Int16: decodeValues<std::int16_t>(src, count, swap, out); break;
+            case ValueType::UInt32: decodeValues<std::uint32_t>(src, count, swap, out); break;
+            case ValueType::Int32: decodeValues<std::int32_t>(src, count, swap, out); break;
+            case ValueType::UInt64: decodeValues<std::uint64_t>(src, count, swap, out); break;
+            case ValueType::Int64: decodeValues<std::int64_t>(src, count, swap, out); break;
+            case ValueType::Float32: decodeValues<float>(src, count, swap, out); break;
+            case ValueType::Float64: decodeValues<double>(src, count, swap, out); break;
+        }
+        m_cursor.pos += bytes;
+    }
+
+    void skipValues(size_t count, ValueType type) {
+        if (!m_binary) {
+            const size_t first = m_tokens->tokenIndexAt(m_cursor.pos);
+            if (first + count > m_tokens->tokenCount()) {
+                throw std::runtime_error("Truncated data in VTK file: " + m_filename);
+            }
+            m_cursor.pos = m_tokens->tokenStart(first + count);
+            return;
+        }
+        m_cursor.skipLine();
+        const size_t bytes = valueBytes(type, count);
+        if (bytes > static_cast<size_t>(m_cursor.end - m_cursor.pos)) {
+            throw std::runtime_error("Truncated binary data in VTK file: " + m_filename);
+        }
+        m_cursor.pos += bytes;
+    }
+
+    // Split surface cells into triangles: count per cell, prefix sum, then
+    // emit in parallel
+    ImportedMesh assemble() {
+        const size_t cellCount = m_cellStart.size();
+        if (m_cellTypes.size() != cellCount) {
+            throw std::runtime_error("VTK CELL_TYPES does not match the number of cells");
+        }
+        const bool haveFaceIds = !m_faceIds.empty();
+        if (haveFaceIds && m_faceIds.size() != cellCount) {
+            throw std::runtime_error("VTK FaceID array does not match the number of cells");
+        }
+
+        std::vector<std::int64_t> firstTriangle(cellCount + 1, 0);
+        size_t skipped = 0;
+        for (size_t c = 0; c < cellCount; c++) {
+            const int count = trianglesInCell(m_cellTypes[c], m_cellSize[c]);
+            if (count == 0) skipped++;
+            firstTriangle[c + 1] = firstTriangle[c] + count;
+        }
+        const size_t triangleCount = static_cast<size_t>(firstTriangle[cellCount]);
+        if (triangleCount > kMaxIndex) {
+            throw std::runtime_error("VTK triangle count exceeds 32-bit index range");
+        }
+
+        ImportedMesh mesh;
+        mesh.skippedCells = skipped;
+        mesh.triangles.resize(3 * triangleCount);
+        mesh.faceIds.resize(triangleCount);
+
+        const std::int64_t nodeCount = static_cast<std::int64_t>(m_nodes.size());
+        std::atomic<bool> indicesValid(true);
+        std::atomic<bool> faceIdsValid(true);
+        parallelForChunks(cellCount, 16384, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++) {
+                const int count = static_cast<int>(firstTriangle[c + 1] - firstTriangle[c]);
+                if (count == 0) continue;
+
+                const std::int64_t* points = m_connectivity.data() + m_cellStart[c];
+                for (int k = 0; k < m_cellSize[c]; k++) {
+                    if (points[k] < 0 || points[k] >= nodeCount) {
+                        indicesValid.store(false, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+
+                std::int32_t faceId = 0;
+                if (haveFaceIds) {
+                    const double value = m_faceIds[c];
+                    if (!(value >= 0.0) || value > static_cast<double>(kMaxIndex)) {
+                        faceIdsValid.store(false, std::memory_order_relaxed);
+                        return;
+                    }
+                    faceId = static_cast<std::int32_t>(std::lround(value));
+                }
+
+                std::int32_t* tri = mesh.triangles.data() + 3 * firstTriangle[c];
+                std::int32_t* faces = mesh.faceIds.data() + firstTriangle[c];
+                auto emit = [&](std::int64_t a, std::int64_t b, std::int64_t d) {
+                    *tri++ = static_cast<std::int32_t>(a);
+                    *tri++ = static_cast<std::int32_t>(b);
+                    *tri++ = static_cast<std::int32_t>(d);
+                    *faces++ = faceId;
+                };
+
+                switch (m_cellTypes[c]) {
+                    case kVtkPixel:
+                        // Pixel corners are in raster order
+                        emit(points[0], points[1], points[3]);
+                        emit(points[0], points[3], points[2]);
+                        break;
+                    case kVtkTriangleStrip:
+                        for (int k = 0; k < count; k++) {
+                            if (k % 2 == 0) emit(points[k], points[k + 1], points[k + 2]);
+                            else emit(points[k + 1], points[k], points[k + 2]);
+                        }
+                        break;
+                    default:
+                        for (int k = 0; k < count; k++) {
+                            emit(points[0], points[k + 1], points[k + 2]);
+                        }
+                        break;
+                }
+            }
+        });
+        if (!indicesValid.load()) {
+            throw std::runtime_error("VTK cell references a point out of range");
+        }
+        if (!faceIdsValid.load()) {
+            throw std::runtime_error("VTK FaceID values must be non-negative integers");
+        }
+
+        mesh.nodes = std::move(m_nodes);
+        return mesh;
+    }
+
+    Cursor m_cursor;
+    std::string m_filename;
+    int m_version = 0;
+    bool m_binary = false;
+    bool m_polyData = false;
+    std::unique_ptr<TokenChunks> m_tokens;
+
+    MeshNodeArrays m_nodes;
+    std::vector<std::int64_t> m_connectivity;
+    std::vector<std::int64_t> m_cellStart;   // Offset of each cell's first point in m_connectivity
+    std::vector<std::int32_t> m_cellSize;
+    std::vector<std::uint8_t> m_cellTypes;
+    std::vector<double> m_faceIds;
+
+    bool m_attributesOnCells = false;
+    size_t m_attributeCount = 0;
+};
+
+ImportedMesh readBinarySTL(const char* data, size_t triangleCount) {
+    if (3 * triangleCount > kMaxIndex) {
+        throw std::runtime_error("STL vertex count exceeds 32-bit index range");
+    }
+
+    ImportedMesh mesh;
+    mesh.nodes.resize(3 * triangleCount);
+    mesh.triangles.resize(3 * triangleCount);
+    mesh.faceIds.assign(triangleCount, 0);
+
+    // 50-byte records: normal, three vertices (little-endian float32), attribute word
+    const bool swap = hostIsBigEndian();
+    parallelForChunks(triangleCount, 16384, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++) {
+            const char* record = data + 84 + 50 * t;
+            float corner[9];
+            decodeValues<float>(record + 12, 9, swap, corner);
+            for (int v = 0; v < 3; v++) {
+                const size_t n = 3 * t + v;
+                mesh.nodes.x[n] = corner[3 * v];
+                mesh.nodes.y[n] = corner[3 * v + 1];
+                mesh.nodes.z[n] = corner[3 * v + 2];
+                mesh.triangles[n] = static_cast<std::int32_t>(n);
+            }
+        }
+    });
+    return mesh;
+}
+
+// ASCII STL: each chunk counts the "vertex" and "solid" keywords that start
+// in it, then parses its vertices into slots given by the prefix sums
+ImportedMesh readAsciiSTL(const char* begin, const char* end) {
+    const std::vector<const char*> bounds = splitAtWhitespace(begin, end);
+    const size_t chunkCount = bounds.size() - 1;
+
+    std::vector<size_t> firstVertex(chunkCount + 1, 0);
+    std::vector<size_t> firstSolid(chunkCount + 1, 0);
+    parallelForChunks(chunkCount, 1, [&](size_t first, size_t last) {
+        for (size_t j = first; j < last; j++) {
+            size_t vertices = 0;
+            size_t solids = 0;
+            forEachToken(bounds[j], bounds[j + 1], end, [&](const char* tokenBegin, const char* tokenEnd) {
+                if (equalsNoCase(tokenBegin, tokenEnd, "vertex")) vertices++;
+                else if (equalsNoCase(tokenBegin, tokenEnd, "solid")) solids++;
+                return true;
+            });
+            firstVertex[j + 1] = vertices;
+            firstSolid[j + 1] = solids;
+        }
+    });
+    for (size_t j = 0; j < chunkCount; j++) {
+        firstVertex[j + 1] += firstVertex[j];
+        firstSolid[j + 1] += firstSolid[j];
+    }
+
+    const size_t vertexCount = firstVertex[chunkCount];
+    if (vertexCount % 3 != 0) {
+        throw std::runtime_error("ASCII STL vertex count is not a multiple of 3");
+    }
+    if (vertexCount > kMaxIndex) {
+        throw std::runtime_error("STL vertex count exceeds 32-bit index range");
+    }
+
+    ImportedMesh mesh;
+    mesh.nodes.resize(vertexCount);
+    mesh.triangles.resize(vertexCount);
+    mesh.faceIds.resize(vertexCount / 3);
+
+    std::atomic<bool> ok(true);
+    parallelForChunks(chunkCount, 1, [&](size_t first, size_t last) {
+        for (size_t j = first; j < last; j++) {
+            size_t vertex = firstVertex[j];
+            size_t solid = firstSolid[j];
+            forEachToken(bounds[j], bounds[j + 1], end, [&](const char* tokenBegin, const char* tokenEnd) {
+                if (equalsNoCase(tokenBegin, tokenEnd, "solid")) {
+                    solid++;
+                    return true;
+                }
+                if (!equalsNoCase(tokenBegin, tokenEnd, "vertex")) return true;
+
+                // The coordinates may continue into the next chunk
+                Cursor coordinates{tokenEnd, end};
+                double value[3];
+                for (double& v : value) {
+                    const std::string_view token = coordinates.next();
+                    if (!parseNumber(token.data(), token.data() + token.size(), v)) {
+                        ok.store(false, std::memory_order_relaxed);
+                        return false;
+                    }
+                }
+                mesh.nodes.x[vertex] = value[0];
+                mesh.nodes.y[vertex] = value[1];
+                mesh.nodes.z[vertex] = value[2];
+                mesh.triangles[vertex] = static_cast<std::int32_t>(vertex);
+                if (vertex % 3 == 0) {
+                    mesh.faceIds[vertex / 3] = static_cast<std::int32_t>(solid > 0 ? solid - 1 : 0);
+                }
+                vertex++;
+                return true;
+            });
+        }
+    });
+    if (!ok.load()) {
+        throw std::runtime_error("Malformed vertex coordinates in ASCII STL file");
+    }
+    return mesh;
+}
+
+} // namespace
+
+ImportedMesh MeshFileReader::readVTK(const std::string& filename) {
+    MappedFile file(filename);
+    return VTKParser(file, filename).parse();
+}
+
+ImportedMesh MeshFileReader::readSTL(const std::string& filename) {
+    MappedFile file(filename);
+    const char* data = file.data();
+    const size_t size = file.size();
+
+    // Binary files are recognised by their exact size; a binary header may
+    // itself start with "solid"
+    if (size >= 84) {
+        std::uint32_t triangleCount;
+        decodeValues<std::uint32_t>(data + 80, 1, hostIsBigEndian(), &triangleCount);
+        if (84 + 50 * static_cast<std::uint64_t>(triangleCount) == size) {
+            return readBinarySTL(data, triangleCount);
+        }
+    }
+
+    Cursor cursor{data, data + size};
+    const std::string_view keyword = cursor.next();
+    if (!equalsNoCase(keyword.data(), keyword.data() + keyword.size(), "solid")) {
+        throw std::runtime_error("Not a valid STL file: " + filename);
+    }
+    return readAsciiSTL(data, data + size);
+}
@@ -0,0 +1,174 @@
+// MeshQualityKernel.cpp
+#include "MeshQualityKernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MESH_QUALITY_HAVE_AVX2 1
+#include <immintrin.h>
+#else
+#define MESH_QUALITY_HAVE_AVX2 0
+#endif
+
+namespace {
+
+const double kDegenerateLength = 1e-12;
+const double kQualityScale = 4.0 * 1.7320508075688772;  // 4 * sqrt(3)
+
+// Cosine of the angle between two edges of length la and lb; a collapsed
+// edge counts as a zero angle
+inline double edgeCosine(double dot, double la, double lb) {
+    if (la < kDegenerateLength || lb < kDegenerateLength) return 1.0;
+    return std::max(-1.0, std::min(1.0, dot / (la * lb)));
+}
+
+} // namespace
+
+bool MeshQualityKernel::hasAVX2() {
+#if MESH_QUALITY_HAVE_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void MeshQualityKernel::compute(const double* x, const double* y, const double* z,
+                                const std::int32_t* triangles, size_t begin, size_t end,
+                                TriangleQualityArrays& out) {
+    if (hasAVX2()) {
+        computeAVX2(x, y, z, triangles, begin, end, out);
+    } else {
+        computeScalar(x, y, z, triangles, begin, end, out);
+    }
+}
+
+void MeshQualityKernel::computeScalar(const double* x, const double* y, const double* z,
+                                      const std::int32_t* triangles, size_t begin, size_t end,
+                                      TriangleQualityArrays& out) {
+    for (size_t e = begin; e < end; e++) {
+        const std::int32_t n0 = triangles[3 * e];
+        const std::int32_t n1 = triangles[3 * e + 1];
+        const std::int32_t n2 = triangles[3 * e + 2];
+
+        // u = p1 - p0, v = p2 - p0, w = p2 - p1
+        const double ux = x[n1] - x[n0], uy = y[n1] - y[n0], uz = z[n1] - z[n0];
+        const double vx = x[n2] - x[n0], vy = y[n2] - y[n0], vz = z[n2] - z[n0];
+        const double wx = x[n2] - x[n1], wy = y[n2] - y[n1], wz = z[n2] - z[n1];
+
+        const double a = std::sqrt(ux * ux + uy * uy + uz * uz);
+        const double b = std::sqrt(wx * wx + wy * wy + wz * wz);
+        const double c = std::sqrt(vx * vx + vy * vy + vz * vz);
+
+        const double nx = uy * vz - uz * vy;
+        const double ny = uz * vx - ux * vz;
+        const double nz = ux * vy - uy * vx;
+        const double area = 0.5 * std::sqrt(nx * nx + ny * ny + nz * nz);
+
+        const double perimeter = a + b + c;
+        double quality = 0.0;
+        if (perimeter >= kDegenerateLength) {
+            quality = std::max(0.0, std::min(1.0, kQualityScale * area / (perimeter * perimeter)));
+        }
+
+        const double cos0 = edgeCosine(ux * vx + uy * vy + uz * vz, a, c);
+        const double cos1 = edgeCosine(-(ux * wx + uy * wy + uz * wz), a, b);
+        const double cos2 = edgeCosine(vx * wx + vy * wy + vz * wz, c, b);
+
+        out.quality[e] = quality;
+        out.minEdge[e] = std::min(std::min(a, b), c);
+        out.maxEdge[e] = std::max(std::max(a, b), c);
+        out.cosMinAngle[e] = std::max(std::max(cos0, cos1), cos2);
+        out.cosMaxAngle[e] = std::min(std::min(cos0, cos1), cos2);
+    }
+}
+
+#if MESH_QUALITY_HAVE_AVX2
+
+namespace {
+
+__attribute__((target("avx2")))
+inline __m256d edgeCosine4(__m256d dot, __m256d la, __m256d lb) {
+    const __m256d eps = _mm256_set1_pd(kDegenerateLength);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d cosine = _mm256_max_pd(_mm256_set1_pd(-1.0),
+                                         _mm256_min_pd(one, _mm256_div_pd(dot, _mm256_mul_pd(la, lb))));
+    const __m256d degenerate = _mm256_or_pd(_mm256_cmp_pd(la, eps, _CMP_LT_OQ),
+                                            _mm256_cmp_pd(lb, eps, _CMP_LT_OQ));
+    return _mm256_blendv_pd(cosine, one, degenerate);
+}
+
+__attribute__((target("avx2")))
+inline __m256d dot4(__m256d ax, __m256d ay, __m256d az, __m256d bx, __m256d by, __m256d bz) {
+    return _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(ax, bx), _mm256_mul_pd(ay, by)),
+                         _mm256_mul_pd(az, bz));
+}
+
+} // namespace
+
+__attribute__((target("avx2")))
+void MeshQualityKernel::computeAVX2(const double* x, const double* y, const double* z,
+                                    const std::int32_t* triangles, size_t begin, size_t end,
+                                    TriangleQualityArrays& out) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d scale = _mm256_set1_pd(kQualityScale);
+    const __m256d eps = _mm256_set1_pd(kDegenerateLength);
+    const __m256d signBit = _mm256_set1_pd(-0.0);
+    // Vertex k of triangles e .. e+3 sits at triangles[3e + k + {0, 3, 6, 9}]
+    const __m128i stride = _mm_setr_epi32(0, 3, 6, 9);
+
+    size_t e = begin;
+    for (; e + 4 <= end; e += 4) {
+        const int* t = reinterpret_cast<const int*>(triangles + 3 * e);
+        const __m128i i0 = _mm_i32gather_epi32(t, stride, 4);
+        const __m128i i1 = _mm_i32gather_epi32(t + 1, stride, 4);
+        const __m128i i2 = _mm_i32gather_epi32(t + 2, stride, 4);
+
+        const __m256d x0 = _mm256_i32gather_pd(x, i0, 8), y0 = _mm256_i32gather_pd(y, i0, 8), z0 = _mm256_i32gather_pd(z, i0, 8);
+        const __m256d x1 = _mm256_i32gather_pd(x, i1, 8), y1 = _mm256_i32gather_pd(y, i1, 8), z1 = _mm256_i32gather_pd(z, i1, 8);
+        const __m256d x2 = _mm256_i32gather_pd(x, i2, 8), y2 = _mm256_i32gather_pd(y, i2, 8), z2 = _mm256_i32gather_pd(z, i2, 8);
+
+        const __m256d ux = _mm256_sub_pd(x1, x0), uy = _mm256_sub_pd(y1, y0), uz = _mm256_sub_pd(z1, z0);
+        const __m256d vx = _mm256_sub_pd(x2, x0), vy = _mm256_sub_pd(y2, y0), vz = _mm256_sub_pd(z2, z0);
+        const __m256d wx = _mm256_sub_pd(x2, x1), wy = _mm256_sub_pd(y2, y1), wz = _mm256_sub_pd(z2, z1);
+
+        const __m256d a = _mm256_sqrt_pd(dot4(ux, uy, uz, ux, uy, uz));
+        const __m256d b = _mm256_sqrt_pd(dot4(wx, wy, wz, wx, wy, wz));
+        const __m256d c = _mm256_sqrt_pd(dot4(vx, vy, vz, vx, vy, vz));
+
+        const __m256d nx = _mm256_sub_pd(_mm256_mul_pd(uy, vz), _mm256_mul_pd(uz, vy));
+        const __m256d ny = _mm256_sub_pd(_mm256_mul_pd(uz, vx), _mm256_mul_pd(ux, vz));
+        const __m256d nz = _mm256_sub_pd(_mm256_mul_pd(ux, vy), _mm256_mul_pd(uy, vx));
+        const __m256d area = _mm256_mul_pd(half, _mm256_sqrt_pd(dot4(nx, ny, nz, nx, ny, nz)));
+
+        const __m256d perimeter = _mm256_add_pd(_mm256_add_pd(a, b), c);
+        __m256d quality = _mm256_div_pd(_mm256_mul_pd(scale, area), _mm256_mul_pd(perimeter, perimeter));
+        quality = _mm256_max_pd(zero, _mm256_min_pd(one, quality));
+        quality = _mm256_blendv_pd(quality, zero, _mm256_cmp_pd(perimeter, eps, _CMP_LT_OQ));
+
+        const __m256d cos0 = edgeCosine4(dot4(ux, uy, uz, vx, vy, vz), a, c);
+        const __m256d cos1 = edgeCosine4(_mm256_xor_pd(signBit, dot4(ux, uy, uz, wx, wy, wz)), a, b);
+        const __m256d cos2 = edgeCosine4(dot4(vx, vy, vz, wx, wy, wz), c, b);
+
+        _mm256_storeu_pd(&out.quality[e], quality);
+        _mm256_storeu_pd(&out.minEdge[e], _mm256_min_pd(_mm256_min_pd(a, b), c));
+        _mm256_storeu_pd(&out.maxEdge[e], _mm256_max_pd(_mm256_max_pd(a, b), c));
+        _mm256_storeu_pd(&out.cosMinAngle[e], _mm256_max_pd(_mm256_max_pd(cos0, cos1), cos2));
+        _mm256_storeu_pd(&out.cosMaxAngle[e], _mm256_min_pd(_mm256_min_pd(cos0, cos1), cos2));
+    }
+
+    computeScalar(x, y, z, triangles, e, end, out);
+}
+
+#else
+
+void MeshQualityKernel::computeAVX2(const double* x, const double* y, const double* z,
+                                    const std::int32_t* triangles, size_t begin, size_t end,
+                                    TriangleQualityArrays& out) {
+    computeScalar(x, y, z, triangles, begin, end, out);
+}
+
+#endif
@@ -0,0 +1,193 @@
+// OutputSink.cpp
+#include "OutputSink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define OUTPUT_SINK_HAVE_POSIX_WRITE 1
+#include <unistd.h>
+#else
+#define OUTPUT_SINK_HAVE_POSIX_WRITE 0
+#include <io.h>
+#endif
+
+OutputSink::OutputSink(const std::string& filename, size_t bufferSize)
+    : m_target(Target::File), m_file(std::fopen(filename.c_str(), "wb")), m_filename(filename),
+      m_buffer(std::max<size_t>(bufferSize, 64)) {
+    if (!m_file) {
+        throw std::runtime_error("Cannot open file for writing: " + filename);
+    }
+    // The sink does its own buffering
+    std::setvbuf(m_file, nullptr, _IONBF, 0);
+}
+
+OutputSink::OutputSink(std::vector<char>& buffer, size_t bufferSize)
+    : m_target(Target::Memory), m_memory(&buffer), m_filename("memory buffer"),
+      m_buffer(std::max<size_t>(bufferSize, 64)) {}
+
+OutputSink::OutputSink(Span span, size_t bufferSize)
+    : m_target(Target::Span), m_span(static_cast<char*>(span.data)), m_spanSize(span.size),
+      m_filename("output span"), m_buffer(std::max<size_t>(bufferSize, 64)) {}
+
+OutputSink::OutputSink(int fd, size_t bufferSize)
+    : m_target(Target::Descriptor), m_descriptor(fd), m_filename("file descriptor " + std::to_string(fd)),
+      m_buffer(std::max<size_t>(bufferSize, 64)) {
+    if (fd < 0) {
+        throw std::runtime_error("Invalid file descriptor for writing");
+    }
+}
+
+OutputSink::~OutputSink() {
+    if (!m_open) return;
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; call close() to observe write errors
+    }
+}
+
+void OutputSink::write(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    if (size > m_buffer.size() - m_used) {
+        drain();
+        // Large blocks bypass the buffer
+        if (size >= m_buffer.size()) {
+            commit(bytes, size);
+            return;
+        }
+    }
+    std::memcpy(m_buffer.data() + m_used, bytes, size);
+    m_used += size;
+}
+
+OutputSink& OutputSink::operator<<(double value) {
+    // Longest shortest-round-trip double is 24 characters
+    if (m_buffer.size() - m_used < 32) drain();
+    char* first = m_buffer.data() + m_used;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    m_used = std::to_chars(first, first + 32, value).ptr - m_buffer.data();
+#else
+    // Floating-point to_chars is unavailable before GCC 11; 17 digits still round-trip
+    m_used += std::snprintf(first, 32, "%.17g", value);
+#endif
+    return *this;
+}
+
+OutputSink& OutputSink::operator<<(float value) {
+    if (m_buffer.size() - m_used < 32) drain();
+    char* first = m_buffer.data() + m_used;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    m_used = std::to_chars(first, first + 32, value).ptr - m_buffer.data();
+#else
+    m_used += std::snprintf(first, 32, "%.9g", static_cast<double>(value));
+#endif
+    return *this;
+}
+
+OutputSink& OutputSink::writeInteger(long long value) {
+    if (m_buffer.size() - m_used < 24) drain();
+    char* first = m_buffer.data() + m_used;
+    m_used = std::to_chars(first, first + 24, value).ptr - m_buffer.data();
+    return *this;
+}
+
+OutputSink& OutputSink::writeInteger(unsigned long long value) {
+    if (m_buffer.size() - m_used < 24) drain();
+    char* first = m_buffer.data() + m_used;
+    m_used = std::to_chars(first, first + 24, value).ptr - m_buffer.data();
+    return *this;
+}
+
+void OutputSink::toLittleEndian(const void* value, unsigned char* bytes, size_t size) {
+    std::memcpy(bytes, value, size);
+    const std::uint16_t one = 1;
+    unsigned char low;
+    std::memcpy(&low, &one, 1);
+    if (low == 0) {
+        std::reverse(bytes, bytes + size);
+    }
+}
+
+void OutputSink::commit(const char* data, size_t size) {
+    if (!m_open) {
+        throw std::runtime_error("Write after close: " + m_filename);
+    }
+    switch (m_target) {
+        case Target::File:
+            if (std::fwrite(data, 1, size, m_file) != size) {
+                throw std::runtime_error("Write failed: " + m_filename);
+            }
+            break;
+        case Target::Memory:
+            m_memory->insert(m_memory->end(), data, data + size);
+            break;
+        case Target::Span:
+            if (size > m_spanSize - m_written) {
+                throw std::runtime_error("Output span too small: " + std::to_string(m_spanSize) + " bytes");
+            }
+            std::memcpy(m_span + m_written, data, size);
+            break;
+        case Target::Descriptor:
+            for (size_t done = 0; done < size;) {
+#if OUTPUT_SINK_HAVE_POSIX_WRITE
+                const ssize_t n = ::write(m_descriptor, data + done, size - done);
+                if (n < 0 && errno == EINTR) continue;
+#else
+                const int n = ::_write(m_descriptor, data + done,
+                                       static_cast<unsigned>(std::min<size_t>(size - done, 1u << 30)));
+#endif
+                if (n <= 0) {
+                    throw std::runtime_error("Write failed: " + m_filename);
+                }
+                done += static_cast<size_t>(n);
+            }
+            break;
+    }
+    m_written += size;
+}
+
+void OutputSink::drain() {
+    if (m_used == 0) return;
+    const size_t used = m_used;
+    m_used = 0;
+    commit(m_buffer.data(), used);
+}
+
+void OutputSink::flush() {
+    drain();
+    if (m_target == Target::File && std::fflush(m_file) != 0) {
+        throw std::runtime_error("Write failed: " + m_filename);
+    }
+}
+
+void OutputSink::close() {
+    if (!m_open) return;
+    if (m_target != Target::File) {
+        try {
+            drain();
+        } catch (...) {
+            m_open = false;
+            throw;
+        }
+        m_open = false;
+        return;
+    }
+    std::FILE* file = m_file;
+    try {
+        drain();
+    } catch (...) {
+        std::fclose(file);
+        m_file = nullptr;
+        m_open = false;
+        throw;
+    }
+    m_file = nullptr;
+    m_open = false;
+    if (std::fclose(file) != 0) {
+        throw std::runtime_error("Write failed: " + m_filename);
+    }
+}
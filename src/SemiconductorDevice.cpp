@@ -2,11 +2,16 @@
 #include "BoundaryMesh.h"
 #include "GeometryBuilder.h"
 #include "VTKExporter.h"
+#include "GLBExporter.h"
 #include "BoundaryMesh.h"
+#include "OutputSink.h"
+#include "ParallelUtils.h"
 
 #include <iostream>
 #include <algorithm>
 #include <stdexcept>
+#include <set>
+#include <cstdint>
 
 // OpenCASCADE includes
 #include <TopoDS.hxx>
@@ -164,6 +169,14 @@ void SemiconductorDevice::refineGlobalMesh(const std::vector<gp_Pnt>& refinement
     m_globalMesh->refine(refinementPoints, localSize);
 }
 
+void SemiconductorDevice::weldGlobalMesh(double tolerance) {
+    if (!m_globalMesh) {
+        throw std::runtime_error("Global mesh not generated");
+    }
+    
+    m_globalMesh->weldNodes(tolerance);
+}
+
 void SemiconductorDevice::exportGeometry(const std::string& filename, const std::string& format) const {
     if (m_deviceShape.IsNull()) {
         throw std::runtime_error("Device geometry not built");
@@ -190,6 +203,23 @@ void SemiconductorDevice::exportGeometry(const std::string& filename, const std:
     }
 }
 
+namespace {
+// Maps VTK, VTK_BINARY, VTU and VTU_ZLIB onto VTKExporter write options
+bool vtkOptionsForFormat(const std::string& upperFormat, VTKWriteOptions& options) {
+    if (upperFormat == "VTK") {
+        options.format = VTKFormat::LegacyASCII;
+    } else if (upperFormat == "VTK_BINARY") {
+        options.format = VTKFormat::LegacyBinary;
+    } else if (upperFormat == "VTU" || upperFormat == "VTU_ZLIB") {
+        options.format = VTKFormat::XMLBinary;
+        options.compress = (upperFormat == "VTU_ZLIB");
+    } else {
+        return false;
+    }
+    return true;
+}
+}
+
 void SemiconductorDevice::exportMesh(const std::string& filename, const std::string& format) const {
     if (!m_globalMesh) {
         throw std::runtime_error("Global mesh not generated");
@@ -198,16 +228,23 @@ void SemiconductorDevice::exportMesh(const std::string& filename, const std::str
     std::string upperFormat = format;
     std::transform(upperFormat.begin(), upperFormat.end(), upperFormat.begin(), ::toupper);
     
-    if (upperFormat == "VTK") {
-        if (!VTKExporter::exportMesh(*m_globalMesh, filename)) {
+    VTKWriteOptions vtkOptions;
+    if (vtkOptionsForFormat(upperFormat, vtkOptions)) {
+        if (!VTKExporter::exportMesh(*m_globalMesh, filename, vtkOptions)) {
             throw std::runtime_error("Failed to export mesh to VTK file: " + filename);
         }
     } else if (upperFormat == "STL") {
         m_globalMesh->exportToSTL(filename);
+    } else if (upperFormat == "STL_BINARY") {
+        m_globalMesh->exportToSTL(filename, true);
     } else if (upperFormat == "GMSH") {
         m_globalMesh->exportToGMSH(filename);
     } else if (upperFormat == "OBJ") {
         m_globalMesh->exportToOBJ(filename);
+    } else if (upperFormat == "GLB") {
+        if (!GLBExporter::exportMesh(*m_globalMesh, filename)) {
+            throw std::runtime_error("Failed to export mesh to GLB file: " + filename);
+        }
     } else {
         throw std::invalid_argument("Unsupported mesh export format: " + format);
     }
@@ -217,15 +254,179 @@ void SemiconductorDevice::exportMeshWithRegions(const std::string& filename, con
     std::string upperFormat = format;
     std::transform(upperFormat.begin(), upperFormat.end(), upperFormat.begin(), ::toupper);
     
-    if (upperFormat != "VTK") {
-        throw std::invalid_argument("Region export currently only supported for VTK format");
+    if (upperFormat == "MSH" || upperFormat == "GMSH") {
+        exportMeshToGmsh(filename);
+        return;
+    }
+    if (upperFormat == "GLB") {
+        // One primitive and material per layer
+        if (!GLBExporter::exportDevice(*this, filename)) {
+            throw std::runtime_error("Failed to export device mesh to GLB file: " + filename);
+        }
+        return;
+    }
+    if (upperFormat == "PVTU") {
+        // One .vtu piece per layer, written concurrently
+        if (!VTKExporter::exportDevicePartitioned(*this, filename)) {
+            throw std::runtime_error("Failed to export partitioned device mesh to " + filename);
+        }
+        return;
+    }
+    VTKWriteOptions vtkOptions;
+    if (!vtkOptionsForFormat(upperFormat, vtkOptions)) {
+        throw std::invalid_argument("Region export currently only supported for VTK, VTU, PVTU, GLB and MSH formats");
     }
     
-    if (!VTKExporter::exportDeviceWithRegions(*this, filename)) {
+    if (!VTKExporter::exportDeviceWithRegions(*this, filename, vtkOptions)) {
         throw std::runtime_error("Failed to export device mesh with regions to " + filename);
     }
 }
 
+namespace {
+const int kRegionPhysicalTagBase = 1;
+const int kMaterialPhysicalTagBase = 101;
+const std::int32_t kGmshTriangle = 2;  // 3-node triangle element type
+}
+
+void SemiconductorDevice::exportMeshToGmsh(const std::string& filename) const {
+    // Node and element tags are numbered consecutively across layers
+    struct LayerBlock {
+        const DeviceLayer* layer;
+        const BoundaryMesh* mesh;
+        std::int32_t entityTag;
+        std::uint64_t firstNodeTag;
+        std::uint64_t firstElementTag;
+    };
+    std::vector<LayerBlock> blocks;
+    std::set<DeviceRegion> regions;
+    std::set<MaterialType> materials;
+    std::uint64_t totalNodes = 0;
+    std::uint64_t totalElements = 0;
+    
+    for (size_t i = 0; i < m_layers.size(); i++) {
+        const BoundaryMesh* mesh = m_layers[i]->getBoundaryMesh();
+        if (!mesh || mesh->getElementCount() == 0) continue;
+        
+        blocks.push_back({m_layers[i].get(), mesh, static_cast<std::int32_t>(i + 1),
+                          totalNodes + 1, totalElements + 1});
+        regions.insert(m_layers[i]->getRegion());
+        materials.insert(m_layers[i]->getMaterial().type);
+        totalNodes += mesh->getNodeCount();
+        totalElements += mesh->getElementCount();
+    }
+    
+    if (blocks.empty()) {
+        throw std::runtime_error("No layer meshes available for export");
+    }
+    
+    OutputSink file(filename);
+    // Fixed-width binary values in host byte order, as MSH binary expects
+    auto put = [&file](auto value) { file.write(&value, sizeof(value)); };
+    
+    // Header: version, binary flag, size_t width, then the integer 1 so
+    // readers can detect the byte order
+    file << "$MeshFormat\n4.1 1 8\n";
+    put(std::int32_t(1));
+    file << "\n$EndMeshFormat\n";
+    
+    // Physical names are always ASCII
+    file << "$PhysicalNames\n" << (regions.size() + materials.size()) << '\n';
+    for (DeviceRegion region : regions) {
+        file << "2 " << (kRegionPhysicalTagBase + getDeviceRegionId(region))
+             << " \"" << getDeviceRegionName(region) << "\"\n";
+    }
+    for (MaterialType material : materials) {
+        file << "2 " << (kMaterialPhysicalTagBase + getMaterialTypeId(material))
+             << " \"" << getMaterialTypeName(material) << "\"\n";
+    }
+    file << "$EndPhysicalNames\n";
+    
+    // Entities: no points, curves or volumes; one bounded surface per layer
+    file << "$Entities\n";
+    put(std::uint64_t(0));
+    put(std::uint64_t(0));
+    put(static_cast<std::uint64_t>(blocks.size()));
+    put(std::uint64_t(0));
+    for (const LayerBlock& block : blocks) {
+        const std::pair<gp_Pnt, gp_Pnt> box = block.mesh->getBoundingBox();
+        put(block.entityTag);
+        const double bounds[6] = {box.first.X(), box.first.Y(), box.first.Z(),
+                                  box.second.X(), box.second.Y(), box.second.Z()};
+        file.write(bounds, sizeof(bounds));
+        put(std::uint64_t(2));
+        put(static_cast<std::int32_t>(kRegionPhysicalTagBase + getDeviceRegionId(block.layer->getRegion())));
+        put(static_cast<std::int32_t>(kMaterialPhysicalTagBase + getMaterialTypeId(block.layer->getMaterial().type)));
+        put(std::uint64_t(0));
+    }
+    file << "\n$EndEntities\n";
+    
+    // Nodes: each block is its tag array followed by its coordinate array,
+    // both gathered in parallel and written in one call
+    file << "$Nodes\n";
+    put(static_cast<std::uint64_t>(blocks.size()));
+    put(totalNodes);
+    put(std::uint64_t(1));
+    put(totalNodes);
+    std::vector<std::uint64_t> tags;
+    std::vector<double> coordinates;
+    for (const LayerBlock& block : blocks) {
+        const MeshNodeArrays& nodes = block.mesh->getNodeArrays();
+        const size_t count = nodes.size();
+        put(std::int32_t(2));
+        put(block.entityTag);
+        put(std::int32_t(0));
+        put(static_cast<std::uint64_t>(count));
+        
+        tags.resize(count);
+        coordinates.resize(3 * count);
+        parallelForChunks(count, 65536, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                tags[i] = block.firstNodeTag + i;
+                coordinates[3 * i] = nodes.x[i];
+                coordinates[3 * i + 1] = nodes.y[i];
+                coordinates[3 * i + 2] = nodes.z[i];
+            }
+        });
+        file.write(tags.data(), tags.size() * sizeof(std::uint64_t));
+        file.write(coordinates.data(), coordinates.size() * sizeof(double));
+    }
+    file << "\n$EndNodes\n";
+    
+    // Elements: one triangle block per layer, records of tag + three node tags
+    file << "$Elements\n";
+    put(static_cast<std::uint64_t>(blocks.size()));
+    put(totalElements);
+    put(std::uint64_t(1));
+    put(totalElements);
+    std::vector<std::uint64_t> records;
+    for (const LayerBlock& block : blocks) {
+        const MeshElementArrays& elements = block.mesh->getElementArrays();
+        const size_t count = elements.size();
+        put(std::int32_t(2));
+        put(block.entityTag);
+        put(kGmshTriangle);
+        put(static_cast<std::uint64_t>(count));
+        
+        records.resize(4 * count);
+        parallelForChunks(count, 65536, [&](size_t begin, size_t end) {
+            for (size_t e = begin; e < end; e++) {
+                const std::int32_t* tri = elements.nodes(e);
+                records[4 * e] = block.firstElementTag + e;
+                records[4 * e + 1] = block.firstNodeTag + tri[0];
+                records[4 * e + 2] = block.firstNodeTag + tri[1];
+                records[4 * e + 3] = block.firstNodeTag + tri[2];
+            }
+        });
+        file.write(records.data(), records.size() * sizeof(std::uint64_t));
+    }
+    file << "\n$EndElements\n";
+    file.close();
+    
+    std::cout << "Exported device mesh to Gmsh MSH 4.1 file: " << filename << std::endl;
+    std::cout << "  Surface entities: " << blocks.size() << ", nodes: " << totalNodes
+              << ", elements: " << totalElements << std::endl;
+}
+
 std::vector<DeviceLayer*> SemiconductorDevice::getLayersByRegion(DeviceRegion region) {
     std::vector<DeviceLayer*> result;
     
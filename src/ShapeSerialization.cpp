@@ -0,0 +1,23 @@
+// ShapeSerialization.cpp
+#include "ShapeSerialization.h"
+
+#include <Standard_Version.hxx>
+
+#if OCC_VERSION_HEX >= 0x070600
+#include <BinTools.hxx>
+#else
+#include <BinTools_ShapeSet.hxx>
+#endif
+
+void writeShapeWithoutMesh(const TopoDS_Shape& shape, std::ostream& stream) {
+#if OCC_VERSION_HEX >= 0x070600
+    BinTools::Write(shape, stream, Standard_False, Standard_False, BinTools_FormatVersion_CURRENT);
+#else
+    // OCCT 7.5 BinTools::Write always includes triangulations; write the
+    // shape set the same way with them turned off
+    BinTools_ShapeSet shapeSet(Standard_False);
+    shapeSet.Add(shape);
+    shapeSet.Write(stream);
+    shapeSet.Write(shape, stream);
+#endif
+}
@@ -0,0 +1,97 @@
+// SpatialHashGrid.cpp
+#include "SpatialHashGrid.h"
+#include "ParallelUtils.h"
+
+#include <cmath>
+#include <stdexcept>
+
+SpatialHashGrid::SpatialHashGrid(const double* x, const double* y, const double* z,
+                                 size_t count, double cellSize)
+    : m_cellSize(cellSize), m_inverseCellSize(1.0 / cellSize), m_bucketMask(0) {
+    if (!(cellSize > 0.0)) {
+        throw std::invalid_argument("SpatialHashGrid: cell size must be positive");
+    }
+
+    // Power-of-two bucket count of roughly twice the point count
+    std::uint32_t bucketCount = 16;
+    while (bucketCount < 2 * count && bucketCount < (1u << 30)) bucketCount <<= 1;
+    m_bucketMask = bucketCount - 1;
+
+    // Hash every point in parallel, then bucket with a counting sort
+    std::vector<std::uint32_t> pointBuckets(count);
+    parallelForChunks(count, 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            pointBuckets[i] = bucketOf(cellCoord(x[i]), cellCoord(y[i]), cellCoord(z[i]));
+        }
+    });
+
+    m_bucketOffsets.assign(static_cast<size_t>(bucketCount) + 1, 0);
+    for (std::uint32_t bucket : pointBuckets) {
+        m_bucketOffsets[bucket + 1]++;
+    }
+    for (std::uint32_t b = 0; b < bucketCount; b++) {
+        m_bucketOffsets[b + 1] += m_bucketOffsets[b];
+    }
+
+    m_bucketPoints.resize(count);
+    std::vector<std::uint32_t> cursor(m_bucketOffsets.begin(), m_bucketOffsets.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+        m_bucketPoints[cursor[pointBuckets[i]]++] = static_cast<std::int32_t>(i);
+    }
+}
+
+std::int64_t SpatialHashGrid::cellCoord(double v) const {
+    return static_cast<std::int64_t>(std::floor(v * m_inverseCellSize));
+}
+
+std::uint32_t SpatialHashGrid::bucketOf(std::int64_t cx, std::int64_t cy, std::int64_t cz) const {
+    const std::uint64_t h = static_cast<std::uint64_t>(cx) * 73856093ULL
+                          ^ static_cast<std::uint64_t>(cy) * 19349663ULL
+                          ^ static_cast<std::uint64_t>(cz) * 83492791ULL;
+    return static_cast<std::uint32_t>((h ^ (h >> 32)) & m_bucketMask);
+}
+
+SpatialHashGrid::WeldResult SpatialHashGrid::weldPoints(const double* x, const double* y, const double* z,
+                                                        size_t count, double tolerance) {
+    WeldResult result;
+    result.remap.resize(count);
+
+    if (!(tolerance > 0.0)) {
+        result.representatives.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            result.remap[i] = static_cast<std::int32_t>(i);
+            result.representatives[i] = static_cast<std::int32_t>(i);
+        }
+        return result;
+    }
+
+    SpatialHashGrid grid(x, y, z, count, tolerance);
+    const double tolerance2 = tolerance * tolerance;
+
+    // For every point find the lowest-index point within tolerance (itself if none)
+    std::vector<std::int32_t> lowest(count);
+    parallelForChunks(count, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            std::int32_t best = static_cast<std::int32_t>(i);
+            grid.forEachNear(x[i], y[i], z[i], [&](std::int32_t j) {
+                if (j >= best) return;
+                const double dx = x[j] - x[i], dy = y[j] - y[i], dz = z[j] - z[i];
+                if (dx * dx + dy * dy + dz * dz <= tolerance2) best = j;
+            });
+            lowest[i] = best;
+        }
+    });
+
+    // Resolve chains in index order; lowest[i] <= i so its target is already final
+    for (size_t i = 0; i < count; i++) {
+        const std::int32_t target = lowest[i];
+        if (target == static_cast<std::int32_t>(i)) {
+            result.remap[i] = static_cast<std::int32_t>(result.representatives.size());
+            result.representatives.push_back(static_cast<std::int32_t>(i));
+        } else {
+            result.remap[i] = result.remap[target];
+        }
+    }
+
+    return result;
+}
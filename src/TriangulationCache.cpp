@@ -0,0 +1,161 @@
+// TriangulationCache.cpp
+#include "TriangulationCache.h"
+#include "ShapeSerialization.h"
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <Poly_Triangle.hxx>
+
+namespace {
+
+// FNV-1a over raw bytes
+struct Fnv1a {
+    std::uint64_t h = 14695981039346656037ULL;
+    void bytes(const void* data, size_t n) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < n; i++) {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+    }
+    void value(double v) {
+        if (v == 0.0) v = 0.0;  // fold -0.0 into +0.0
+        bytes(&v, sizeof(v));
+    }
+    void value(std::int64_t v) { bytes(&v, sizeof(v)); }
+};
+
+} // namespace
+
+size_t TriangulationCache::MeshData::byteSize() const {
+    size_t triangulationBytes = triangulations.size() * sizeof(Handle(Poly_Triangulation));
+    for (const Handle(Poly_Triangulation)& triangulation : triangulations) {
+        if (triangulation.IsNull()) continue;
+        triangulationBytes += sizeof(Poly_Triangulation)
+                            + triangulation->NbNodes() * sizeof(gp_Pnt)
+                            + triangulation->NbTriangles() * sizeof(Poly_Triangle);
+    }
+    return sizeof(MeshData)
+         + triangulationBytes
+         + nodes.size() * 3 * sizeof(double)
+         + triangles.size() * sizeof(std::int32_t)
+         + faceIds.size() * sizeof(std::int32_t)
+         + faces.size() * sizeof(FaceRange);
+}
+
+size_t TriangulationCache::KeyHash::operator()(Key const& k) const noexcept {
+    Fnv1a f;
+    f.value(static_cast<std::int64_t>(k.shapeHash));
+    f.value(k.deflection);
+    f.value(k.angle);
+    return static_cast<size_t>(f.h);
+}
+
+TriangulationCache::TriangulationCache(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+TriangulationCache& TriangulationCache::instance() {
+    static TriangulationCache cache;
+    return cache;
+}
+
+std::uint64_t TriangulationCache::fingerprint(const TopoDS_Shape& shape) {
+    Fnv1a f;
+    if (shape.IsNull()) return f.h;
+
+    // Locations are part of the serialization: triangulations are stored in
+    // face-local coordinates, so faces that only differ by location must not
+    // share an entry
+    std::ostringstream stream(std::ios::out | std::ios::binary);
+    writeShapeWithoutMesh(shape, stream);
+    const std::string data = stream.str();
+    f.bytes(data.data(), data.size());
+    return f.h;
+}
+
+std::shared_ptr<const TriangulationCache::MeshData> TriangulationCache::tryGet(const Key& key) {
+    std::lock_guard lock(mtx_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        stats_.misses++;
+        return nullptr;
+    }
+    stats_.hits++;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->second;
+}
+
+void TriangulationCache::put(const Key& key, std::shared_ptr<const MeshData> value) {
+    if (!value) return;
+    const size_t size = value->byteSize();
+
+    std::lock_guard lock(mtx_);
+    if (size > max_bytes_) return;
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        bytes_ -= it->second->second->byteSize();
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    lru_.emplace_front(key, std::move(value));
+    index_[key] = lru_.begin();
+    bytes_ += size;
+    evictToBudget();
+}
+
+void TriangulationCache::clear() {
+    std::lock_guard lock(mtx_);
+    lru_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
+
+void TriangulationCache::setMaxBytes(size_t max_bytes) {
+    std::lock_guard lock(mtx_);
+    max_bytes_ = max_bytes;
+    evictToBudget();
+}
+
+size_t TriangulationCache::getMaxBytes() const {
+    std::lock_guard lock(mtx_);
+    return max_bytes_;
+}
+
+TriangulationCache::Statistics TriangulationCache::getStatistics() const {
+    std::lock_guard lock(mtx_);
+    Statistics stats = stats_;
+    stats.entries = lru_.size();
+    stats.bytes = bytes_;
+    return stats;
+}
+
+void TriangulationCache::resetStatistics() {
+    std::lock_guard lock(mtx_);
+    stats_ = Statistics();
+}
+
+void TriangulationCache::printStatistics() const {
+    const Statistics stats = getStatistics();
+    const size_t lookups = stats.hits + stats.misses;
+    std::cout << "=== Triangulation Cache ===" << std::endl;
+    std::cout << "Entries: " << stats.entries << " (" << stats.bytes / 1024 << " KiB of "
+              << getMaxBytes() / 1024 << " KiB)" << std::endl;
+    std::cout << "Hits: " << stats.hits << ", misses: " << stats.misses
+              << ", evictions: " << stats.evictions << std::endl;
+    if (lookups > 0) {
+        std::cout << "Hit rate: " << (100.0 * stats.hits / lookups) << "%" << std::endl;
+    }
+}
+
+void TriangulationCache::evictToBudget() {
+    while (bytes_ > max_bytes_ && !lru_.empty()) {
+        const Entry& victim = lru_.back();
+        bytes_ -= victim.second->byteSize();
+        index_.erase(victim.first);
+        lru_.pop_back();
+        stats_.evictions++;
+    }
+}
@@ -1,261 +1,105 @@
 #include "VTKExporter.h"
 #include "BoundaryMesh.h"
 #include "SemiconductorDevice.h"
+#include "ParallelUtils.h"
+#include "SpatialHashGrid.h"
 
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <limits>
+#include <stdexcept>
 
-bool VTKExporter::exportMesh(const BoundaryMesh& mesh, const std::string& filename) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Cannot open file for writing: " << filename << std::endl;
-        return false;
-    }
-    
-    writeVTKHeader(file, "Boundary Mesh");
-    writeVTKPoints(file, mesh);
-    writeVTKCells(file, mesh);
+bool VTKExporter::exportMesh(const BoundaryMesh& mesh, const std::string& filename,
+                             const VTKWriteOptions& options) {
+    VTKTriangleGrid grid;
+    appendMeshGeometry(grid, mesh);
     
-    // Cell types (5 = triangle)
-    file << "CELL_TYPES " << mesh.getElementCount() << std::endl;
-    for (size_t i = 0; i < mesh.getElementCount(); i++) {
-        file << "5" << std::endl;
+    if (!writeGrid(grid, filename, "Boundary Mesh", options)) {
+        return false;
     }
-    
-    // Ensure file ends properly
-    file << std::endl;
-    file.close();
     std::cout << "Exported mesh to VTK file: " << filename << std::endl;
     return true;
 }
 
+bool VTKExporter::exportMesh(const BoundaryMesh& mesh, OutputSink& out,
+                             const VTKWriteOptions& options) {
+    VTKTriangleGrid grid;
+    appendMeshGeometry(grid, mesh);
+    return writeGrid(grid, out, "Boundary Mesh", options);
+}
+
 bool VTKExporter::exportMeshWithCustomData(const BoundaryMesh& mesh, 
                                           const std::string& filename,
                                           const std::vector<int>& materialIds, 
                                           const std::vector<int>& regionIds, 
-                                          const std::vector<std::string>& /* layerNames */) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Cannot open file for writing: " << filename << std::endl;
-        return false;
-    }
-    
-    writeVTKHeader(file, "Semiconductor Device Boundary Mesh with Custom Regions");
-    writeVTKPoints(file, mesh);
-    writeVTKCells(file, mesh);
-    
-    // Cell types (5 = triangle)
-    file << "CELL_TYPES " << mesh.getElementCount() << std::endl;
-    for (size_t i = 0; i < mesh.getElementCount(); i++) {
-        file << "5" << std::endl;
-    }
-    
-    // Cell data - this is where we add region information
-    file << "CELL_DATA " << mesh.getElementCount() << std::endl;
-    
-    // Material ID data
-    if (!materialIds.empty() && materialIds.size() >= mesh.getElementCount()) {
-        file << "SCALARS MaterialID int 1" << std::endl;
-        file << "LOOKUP_TABLE default" << std::endl;
-        for (size_t i = 0; i < mesh.getElementCount(); i++) {
-            file << materialIds[i] << std::endl;
-        }
-        file << std::endl;
-    }
-    
-    // Region ID data
-    if (!regionIds.empty() && regionIds.size() >= mesh.getElementCount()) {
-        file << "SCALARS RegionID int 1" << std::endl;
-        file << "LOOKUP_TABLE default" << std::endl;
-        for (size_t i = 0; i < mesh.getElementCount(); i++) {
-            file << regionIds[i] << std::endl;
-        }
-        file << std::endl;
-    }
-    
-    // Face ID data (existing functionality)
-    file << "SCALARS FaceID int 1" << std::endl;
-    file << "LOOKUP_TABLE default" << std::endl;
-    const auto& elements = mesh.getElements();
-    for (const auto& element : elements) {
-        file << element->faceId << std::endl;
-    }
-    file << std::endl;
-    
-    // Element quality data
-    file << "SCALARS ElementQuality float 1" << std::endl;
-    file << "LOOKUP_TABLE default" << std::endl;
-    for (const auto& element : elements) {
-        double quality = mesh.calculateElementQuality(*element);
-        file << quality << std::endl;
-    }
-    file << std::endl;
+                                          const std::vector<std::string>& /* layerNames */,
+                                          const VTKWriteOptions& options) {
+    VTKTriangleGrid grid;
+    buildCustomDataGrid(mesh, materialIds, regionIds, grid);
     
-    // Element area data
-    file << "SCALARS ElementArea float 1" << std::endl;
-    file << "LOOKUP_TABLE default" << std::endl;
-    for (const auto& element : elements) {
-        file << element->area << std::endl;
+    if (!writeGrid(grid, filename, "Semiconductor Device Boundary Mesh with Custom Regions", options)) {
+        return false;
     }
-    
-    file.close();
     std::cout << "Exported mesh with custom region data to VTK file: " << filename << std::endl;
     return true;
 }
 
+bool VTKExporter::exportMeshWithCustomData(const BoundaryMesh& mesh,
+                                          OutputSink& out,
+                                          const std::vector<int>& materialIds,
+                                          const std::vector<int>& regionIds,
+                                          const VTKWriteOptions& options) {
+    VTKTriangleGrid grid;
+    buildCustomDataGrid(mesh, materialIds, regionIds, grid);
+    return writeGrid(grid, out, "Semiconductor Device Boundary Mesh with Custom Regions", options);
+}
+
 bool VTKExporter::exportMeshWithRegions(const BoundaryMesh& mesh,
                                        const DeviceLayer& layer,
                                        int layerIndex,
-                                       const std::string& filename) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Cannot open file for writing: " << filename << std::endl;
-        return false;
-    }
+                                       const std::string& filename,
+                                       const VTKWriteOptions& options) {
+    VTKTriangleGrid grid;
+    buildLayerGrid(mesh, layer, layerIndex, grid);
     
-    writeVTKHeader(file, "Semiconductor Device Boundary Mesh with Regions");
-    writeVTKPoints(file, mesh);
-    writeVTKCells(file, mesh);
-    
-    // Cell types (5 = triangle)
-    file << "CELL_TYPES " << mesh.getElementCount() << std::endl;
-    for (size_t i = 0; i < mesh.getElementCount(); i++) {
-        file << "5" << std::endl;
+    if (!writeGrid(grid, filename, "Semiconductor Device Boundary Mesh with Regions", options)) {
+        return false;
     }
-    
-    // Cell data with region information
-    writeVTKCellData(file, mesh, layer, layerIndex);
-    
-    file.close();
     std::cout << "Exported mesh with region data to VTK file: " << filename << std::endl;
     return true;
 }
 
+bool VTKExporter::exportMeshWithRegions(const BoundaryMesh& mesh,
+                                       const DeviceLayer& layer,
+                                       int layerIndex,
+                                       OutputSink& out,
+                                       const VTKWriteOptions& options) {
+    VTKTriangleGrid grid;
+    buildLayerGrid(mesh, layer, layerIndex, grid);
+    return writeGrid(grid, out, "Semiconductor Device Boundary Mesh with Regions", options);
+}
+
 bool VTKExporter::exportDeviceWithRegions(const SemiconductorDevice& device, 
-                                         const std::string& filename) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Cannot open file for writing: " << filename << std::endl;
-        return false;
-    }
-    
-    // Collect all layer meshes and calculate total nodes/elements
+                                         const std::string& filename,
+                                         const VTKWriteOptions& options) {
+    // Collect all layer meshes
     std::vector<const BoundaryMesh*> layerMeshes;
     std::vector<const DeviceLayer*> meshLayers;
-    size_t totalNodes = 0;
-    size_t totalElements = 0;
-    
-    const auto& layers = device.getLayers();
-    for (const auto& layer : layers) {
-        const BoundaryMesh* mesh = layer->getBoundaryMesh();
-        if (mesh && mesh->getNodeCount() > 0 && mesh->getElementCount() > 0) {
-            layerMeshes.push_back(mesh);
-            meshLayers.push_back(layer.get());
-            totalNodes += mesh->getNodeCount();
-            totalElements += mesh->getElementCount();
-        }
-    }
-    
+    collectLayerMeshes(device, layerMeshes, meshLayers);
     if (layerMeshes.empty()) {
         std::cerr << "No layer meshes available for export" << std::endl;
         return false;
     }
     
-    // Write VTK header
-    writeVTKHeader(file, "Semiconductor Device Mesh");
-    
-    // Export all points
-    file << "POINTS " << totalNodes << " float" << std::endl;
-    for (const auto* mesh : layerMeshes) {
-        const auto& nodes = mesh->getNodes();
-        for (const auto& node : nodes) {
-            file << node->point.X() << " " << node->point.Y() << " " << node->point.Z() << std::endl;
-        }
-    }
-    
-    // Export all cells with adjusted node indices
-    file << "CELLS " << totalElements << " " << (totalElements * 4) << std::endl;
-    size_t nodeOffset = 0;
-    for (const auto* mesh : layerMeshes) {
-        const auto& elements = mesh->getElements();
-        for (const auto& element : elements) {
-            file << "3 " << (element->nodeIds[0] + nodeOffset) << " "
-                 << (element->nodeIds[1] + nodeOffset) << " "
-                 << (element->nodeIds[2] + nodeOffset) << std::endl;
-        }
-        nodeOffset += mesh->getNodeCount();
-    }
-    
-    // Cell types (all triangles)
-    file << "CELL_TYPES " << totalElements << std::endl;
-    for (size_t i = 0; i < totalElements; i++) {
-        file << "5" << std::endl;
-    }
-    
-    // Cell data with region information
-    file << "CELL_DATA " << totalElements << std::endl;
-    
-    // Material ID data
-    file << "SCALARS MaterialID int 1" << std::endl;
-    file << "LOOKUP_TABLE default" << std::endl;
-    for (size_t layerIdx = 0; layerIdx < meshLayers.size(); layerIdx++) {
-        const DeviceLayer* layer = meshLayers[layerIdx];
-        const BoundaryMesh* mesh = layerMeshes[layerIdx];
-        int materialId = materialTypeToID(layer->getMaterial().type);
-        for (size_t i = 0; i < mesh->getElementCount(); i++) {
-            file << materialId << std::endl;
-        }
-    }
-    file << std::endl;
+    VTKTriangleGrid grid;
+    buildDeviceGrid(layerMeshes, meshLayers, grid);
+    const size_t totalNodes = grid.pointCount();
+    const size_t totalElements = grid.cellCount();
     
-    // Region ID data
-    file << "SCALARS RegionID int 1" << std::endl;
-    file << "LOOKUP_TABLE default" << std::endl;
-    for (size_t layerIdx = 0; layerIdx < meshLayers.size(); layerIdx++) {
-        const DeviceLayer* layer = meshLayers[layerIdx];
-        const BoundaryMesh* mesh = layerMeshes[layerIdx];
-        int regionId = deviceRegionToID(layer->getRegion());
-        for (size_t i = 0; i < mesh->getElementCount(); i++) {
-            file << regionId << std::endl;
-        }
-    }
-    file << std::endl;
-    
-    // Layer index data
-    file << "SCALARS LayerIndex int 1" << std::endl;
-    file << "LOOKUP_TABLE default" << std::endl;
-    for (size_t layerIdx = 0; layerIdx < meshLayers.size(); layerIdx++) {
-        const BoundaryMesh* mesh = layerMeshes[layerIdx];
-        for (size_t i = 0; i < mesh->getElementCount(); i++) {
-            file << layerIdx << std::endl;
-        }
-    }
-    file << std::endl;
-    
-    // Element quality data
-    file << "SCALARS ElementQuality float 1" << std::endl;
-    file << "LOOKUP_TABLE default" << std::endl;
-    for (const auto* mesh : layerMeshes) {
-        const auto& elements = mesh->getElements();
-        for (const auto& element : elements) {
-            double quality = mesh->calculateElementQuality(*element);
-            file << quality << std::endl;
-        }
-    }
-    file << std::endl;
-    
-    // Element area data
-    file << "SCALARS ElementArea float 1" << std::endl;
-    file << "LOOKUP_TABLE default" << std::endl;
-    for (const auto* mesh : layerMeshes) {
-        const auto& elements = mesh->getElements();
-        for (const auto& element : elements) {
-            file << element->area << std::endl;
-        }
+    if (!writeGrid(grid, filename, "Semiconductor Device Mesh", options)) {
+        return false;
     }
-    
-    file.close();
     std::cout << "Exported multi-region mesh to VTK file: " << filename << std::endl;
     std::cout << "  Total layers: " << layerMeshes.size() << std::endl;
     std::cout << "  Total nodes: " << totalNodes << std::endl;
@@ -280,6 +124,160 @@ bool VTKExporter::exportDeviceWithRegions(const SemiconductorDevice& device,
     return true;
 }
 
+bool VTKExporter::exportDeviceWithRegions(const SemiconductorDevice& device,
+                                         OutputSink& out,
+                                         const VTKWriteOptions& options) {
+    std::vector<const BoundaryMesh*> layerMeshes;
+    std::vector<const DeviceLayer*> meshLayers;
+    collectLayerMeshes(device, layerMeshes, meshLayers);
+    if (layerMeshes.empty()) {
+        std::cerr << "No layer meshes available for export" << std::endl;
+        return false;
+    }
+    
+    VTKTriangleGrid grid;
+    buildDeviceGrid(layerMeshes, meshLayers, grid);
+    return writeGrid(grid, out, "Semiconductor Device Mesh", options);
+}
+
+bool VTKExporter::exportDeviceWelded(const SemiconductorDevice& device,
+                                     const std::string& filename,
+                                     double tolerance,
+                                     const VTKWriteOptions& options) {
+    std::vector<const BoundaryMesh*> layerMeshes;
+    std::vector<const DeviceLayer*> meshLayers;
+    collectLayerMeshes(device, layerMeshes, meshLayers);
+    if (layerMeshes.empty()) {
+        std::cerr << "No layer meshes available for export" << std::endl;
+        return false;
+    }
+    if (!(tolerance > 0.0)) {
+        std::cerr << "Weld tolerance must be positive" << std::endl;
+        return false;
+    }
+    
+    VTKTriangleGrid grid;
+    buildDeviceGrid(layerMeshes, meshLayers, grid);
+    const size_t inputNodes = grid.pointCount();
+    const size_t droppedCells = weldGrid(grid, tolerance);
+    
+    if (!writeGrid(grid, filename, "Semiconductor Device Conformal Mesh", options)) {
+        return false;
+    }
+    std::cout << "Exported welded multi-region mesh to VTK file: " << filename << std::endl;
+    std::cout << "  Total layers: " << layerMeshes.size() << std::endl;
+    std::cout << "  Nodes: " << inputNodes << " -> " << grid.pointCount()
+              << " (tolerance " << tolerance << ")" << std::endl;
+    std::cout << "  Total elements: " << grid.cellCount();
+    if (droppedCells > 0) std::cout << " (" << droppedCells << " collapsed elements dropped)";
+    std::cout << std::endl;
+    return true;
+}
+
+bool VTKExporter::exportDeviceWelded(const SemiconductorDevice& device,
+                                     OutputSink& out,
+                                     double tolerance,
+                                     const VTKWriteOptions& options) {
+    std::vector<const BoundaryMesh*> layerMeshes;
+    std::vector<const DeviceLayer*> meshLayers;
+    collectLayerMeshes(device, layerMeshes, meshLayers);
+    if (layerMeshes.empty()) {
+        std::cerr << "No layer meshes available for export" << std::endl;
+        return false;
+    }
+    if (!(tolerance > 0.0)) {
+        std::cerr << "Weld tolerance must be positive" << std::endl;
+        return false;
+    }
+    
+    VTKTriangleGrid grid;
+    buildDeviceGrid(layerMeshes, meshLayers, grid);
+    weldGrid(grid, tolerance);
+    return writeGrid(grid, out, "Semiconductor Device Conformal Mesh", options);
+}
+
+bool VTKExporter::exportDevicePartitioned(const SemiconductorDevice& device,
+                                          const std::string& filename,
+                                          VTKPartitioning partitioning,
+                                          size_t pieceCount,
+                                          bool compress) {
+    std::vector<const BoundaryMesh*> layerMeshes;
+    std::vector<const DeviceLayer*> meshLayers;
+    collectLayerMeshes(device, layerMeshes, meshLayers);
+    if (layerMeshes.empty()) {
+        std::cerr << "No layer meshes available for export" << std::endl;
+        return false;
+    }
+    
+    VTKTriangleGrid grid;
+    buildDeviceGrid(layerMeshes, meshLayers, grid);
+    const size_t cellCount = grid.cellCount();
+    std::vector<std::int32_t> cellPiece(cellCount);
+    
+    if (partitioning == VTKPartitioning::ByLayer) {
+        const VTKCellArray* layerIndex = grid.findArray("LayerIndex");
+        if (layerIndex == nullptr || layerIndex->isFloat) {
+            std::cerr << "Device grid has no LayerIndex array to partition by" << std::endl;
+            return false;
+        }
+        cellPiece = layerIndex->ints;
+        pieceCount = layerMeshes.size();
+    } else {
+        if (pieceCount == 0) {
+            pieceCount = static_cast<size_t>(std::max(1, OSD_Parallel::NbLogicalProcessors()));
+        }
+        pieceCount = std::min(pieceCount, cellCount);
+        
+        // Slab along the longest extent of the device
+        double lo[3], hi[3];
+        for (int k = 0; k < 3; k++) {
+            lo[k] = std::numeric_limits<double>::max();
+            hi[k] = std::numeric_limits<double>::lowest();
+        }
+        for (size_t i = 0; i < grid.pointCount(); i++) {
+            for (int k = 0; k < 3; k++) {
+                lo[k] = std::min(lo[k], grid.points[3 * i + k]);
+                hi[k] = std::max(hi[k], grid.points[3 * i + k]);
+            }
+        }
+        int axis = 0;
+        for (int k = 1; k < 3; k++) {
+            if (hi[k] - lo[k] > hi[axis] - lo[axis]) axis = k;
+        }
+        
+        std::vector<double> keys(cellCount);
+        parallelForChunks(cellCount, 1 << 14, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++) {
+                const std::int32_t* tri = &grid.connectivity[3 * c];
+                keys[c] = grid.points[3 * tri[0] + axis] + grid.points[3 * tri[1] + axis] +
+                          grid.points[3 * tri[2] + axis];
+            }
+        });
+        std::vector<size_t> order(cellCount);
+        for (size_t c = 0; c < cellCount; c++) order[c] = c;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+        });
+        for (size_t rank = 0; rank < cellCount; rank++) {
+            cellPiece[order[rank]] = static_cast<std::int32_t>(rank * pieceCount / cellCount);
+        }
+    }
+    
+    size_t written = 0;
+    try {
+        written = VTKGridWriter::writePartitioned(grid, cellPiece, pieceCount, filename, compress);
+    } catch (const std::exception& e) {
+        std::cerr << "Error writing partitioned VTK files: " << e.what() << std::endl;
+        return false;
+    }
+    
+    std::cout << "Exported partitioned mesh to PVTU file: " << filename << std::endl;
+    std::cout << "  Pieces: " << written << std::endl;
+    std::cout << "  Total nodes: " << grid.pointCount() << std::endl;
+    std::cout << "  Total elements: " << cellCount << std::endl;
+    return true;
+}
+
 int VTKExporter::materialTypeToID(MaterialType material) {
     return static_cast<int>(material);
 }
@@ -314,89 +312,260 @@ std::string VTKExporter::deviceRegionToName(DeviceRegion region) {
     }
 }
 
-void VTKExporter::writeVTKHeader(std::ofstream& file, const std::string& title) {
-    file << "# vtk DataFile Version 3.0" << std::endl;
-    file << title << std::endl;
-    file << "ASCII" << std::endl;
-    file << "DATASET UNSTRUCTURED_GRID" << std::endl;
-}
-
-void VTKExporter::writeVTKPoints(std::ofstream& file, const BoundaryMesh& mesh) {
-    file << "POINTS " << mesh.getNodeCount() << " float" << std::endl;
-    const auto& nodes = mesh.getNodes();
-    for (const auto& node : nodes) {
-        file << node->point.X() << " " << node->point.Y() << " " << node->point.Z() << std::endl;
+bool VTKExporter::writeGrid(const VTKTriangleGrid& grid,
+                            const std::string& filename,
+                            const std::string& title,
+                            const VTKWriteOptions& options) {
+    try {
+        VTKGridWriter::write(grid, filename, title, options);
+    } catch (const std::exception& e) {
+        std::cerr << "Error writing VTK file: " << e.what() << std::endl;
+        return false;
     }
+    return true;
 }
 
-void VTKExporter::writeVTKCells(std::ofstream& file, const BoundaryMesh& mesh, int pointOffset) {
-    file << "CELLS " << mesh.getElementCount() << " " << (mesh.getElementCount() * 4) << std::endl;
-    const auto& elements = mesh.getElements();
-    for (const auto& element : elements) {
-        file << "3 " << (element->nodeIds[0] + pointOffset) << " " 
-             << (element->nodeIds[1] + pointOffset) << " " << (element->nodeIds[2] + pointOffset) << std::endl;
+bool VTKExporter::writeGrid(const VTKTriangleGrid& grid,
+                            OutputSink& out,
+                            const std::string& title,
+                            const VTKWriteOptions& options) {
+    try {
+        VTKGridWriter::write(grid, out, title, options);
+    } catch (const std::exception& e) {
+        std::cerr << "Error writing VTK data: " << e.what() << std::endl;
+        return false;
     }
+    return true;
 }
 
-void VTKExporter::writeVTKCellData(std::ofstream& file, 
-                                  const BoundaryMesh& mesh,
-                                  const DeviceLayer& layer,
-                                  int layerIndex) {
-    size_t numElements = mesh.getElementCount();
+void VTKExporter::appendMeshGeometry(VTKTriangleGrid& grid, const BoundaryMesh& mesh) {
+    const MeshNodeArrays& nodes = mesh.getNodeArrays();
+    const MeshElementArrays& elements = mesh.getElementArrays();
+    const size_t pointOffset = grid.pointCount();
+    const size_t pointBase = grid.points.size();
+    const size_t cellBase = grid.connectivity.size();
+    grid.points.resize(pointBase + nodes.size() * 3);
+    grid.connectivity.resize(cellBase + elements.triangles.size());
+    
+    double* points = grid.points.data() + pointBase;
+    parallelForChunks(nodes.size(), 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            points[3 * i] = nodes.x[i];
+            points[3 * i + 1] = nodes.y[i];
+            points[3 * i + 2] = nodes.z[i];
+        }
+    });
     
-    // Cell data section header
-    file << "CELL_DATA " << numElements << std::endl;
+    std::int32_t* cells = grid.connectivity.data() + cellBase;
+    const std::int32_t offset = static_cast<std::int32_t>(pointOffset);
+    parallelForChunks(elements.triangles.size(), 1 << 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            cells[i] = elements.triangles[i] + offset;
+        }
+    });
+}
+
+void VTKExporter::buildCustomDataGrid(const BoundaryMesh& mesh,
+                                      const std::vector<int>& materialIds,
+                                      const std::vector<int>& regionIds,
+                                      VTKTriangleGrid& grid) {
+    appendMeshGeometry(grid, mesh);
+    const size_t numElements = grid.cellCount();
+    const MeshElementArrays& elements = mesh.getElementArrays();
     
     // Material ID data
-    file << "SCALARS MaterialID int 1" << std::endl;
-    file << "LOOKUP_TABLE default" << std::endl;
-    int materialId = materialTypeToID(layer.getMaterial().type);
-    for (size_t i = 0; i < numElements; i++) {
-        file << materialId << std::endl;
+    if (!materialIds.empty() && materialIds.size() >= numElements) {
+        std::copy_n(materialIds.begin(), numElements, grid.addIntArray("MaterialID").ints.begin());
     }
-    file << std::endl;
     
     // Region ID data
-    file << "SCALARS RegionID int 1" << std::endl;
-    file << "LOOKUP_TABLE default" << std::endl;
-    int regionId = deviceRegionToID(layer.getRegion());
-    for (size_t i = 0; i < numElements; i++) {
-        file << regionId << std::endl;
+    if (!regionIds.empty() && regionIds.size() >= numElements) {
+        std::copy_n(regionIds.begin(), numElements, grid.addIntArray("RegionID").ints.begin());
     }
-    file << std::endl;
     
-    // Layer index data
-    file << "SCALARS LayerIndex int 1" << std::endl;
-    file << "LOOKUP_TABLE default" << std::endl;
-    for (size_t i = 0; i < numElements; i++) {
-        file << layerIndex << std::endl;
-    }
-    file << std::endl;
+    // Face ID data (existing functionality)
+    std::copy_n(elements.faceIds.begin(), numElements, grid.addIntArray("FaceID").ints.begin());
+    
+    // Element quality and area data
+    const std::vector<double>& qualities = mesh.getElementQualityArrays().quality;
+    std::copy_n(qualities.begin(), numElements, grid.addFloatArray("ElementQuality").floats.begin());
+    std::copy_n(elements.areas.begin(), numElements, grid.addFloatArray("ElementArea").floats.begin());
+}
+
+void VTKExporter::buildLayerGrid(const BoundaryMesh& mesh,
+                                 const DeviceLayer& layer,
+                                 int layerIndex,
+                                 VTKTriangleGrid& grid) {
+    appendMeshGeometry(grid, mesh);
+    const size_t numElements = grid.cellCount();
+    const MeshElementArrays& elements = mesh.getElementArrays();
+    
+    // Cell data with region information
+    grid.cellData.reserve(6);
+    VTKCellArray& materialIds = grid.addIntArray("MaterialID");
+    std::fill(materialIds.ints.begin(), materialIds.ints.end(), materialTypeToID(layer.getMaterial().type));
+    VTKCellArray& regionIds = grid.addIntArray("RegionID");
+    std::fill(regionIds.ints.begin(), regionIds.ints.end(), deviceRegionToID(layer.getRegion()));
+    VTKCellArray& layerIndices = grid.addIntArray("LayerIndex");
+    std::fill(layerIndices.ints.begin(), layerIndices.ints.end(), layerIndex);
     
     // Face ID data (existing functionality)
-    file << "SCALARS FaceID int 1" << std::endl;
-    file << "LOOKUP_TABLE default" << std::endl;
-    const auto& elements = mesh.getElements();
-    for (const auto& element : elements) {
-        file << element->faceId << std::endl;
+    std::copy_n(elements.faceIds.begin(), numElements, grid.addIntArray("FaceID").ints.begin());
+    
+    // Element quality and area data
+    const std::vector<double>& qualities = mesh.getElementQualityArrays().quality;
+    std::copy_n(qualities.begin(), numElements, grid.addFloatArray("ElementQuality").floats.begin());
+    std::copy_n(elements.areas.begin(), numElements, grid.addFloatArray("ElementArea").floats.begin());
+}
+
+void VTKExporter::collectLayerMeshes(const SemiconductorDevice& device,
+                                     std::vector<const BoundaryMesh*>& meshes,
+                                     std::vector<const DeviceLayer*>& layers) {
+    meshes.clear();
+    layers.clear();
+    for (const auto& layer : device.getLayers()) {
+        const BoundaryMesh* mesh = layer->getBoundaryMesh();
+        if (mesh && mesh->getNodeCount() > 0 && mesh->getElementCount() > 0) {
+            meshes.push_back(mesh);
+            layers.push_back(layer.get());
+        }
     }
-    file << std::endl;
-    
-    // Element quality data
-    file << "SCALARS ElementQuality float 1" << std::endl;
-    file << "LOOKUP_TABLE default" << std::endl;
-    for (const auto& element : elements) {
-        double quality = mesh.calculateElementQuality(*element);
-        file << quality << std::endl;
+}
+
+void VTKExporter::buildDeviceGrid(const std::vector<const BoundaryMesh*>& meshes,
+                                  const std::vector<const DeviceLayer*>& layers,
+                                  VTKTriangleGrid& grid) {
+    // Prefix offsets: layer l owns nodes [nodeStarts[l], nodeStarts[l+1]) and
+    // cells [cellStarts[l], cellStarts[l+1]) of the merged grid
+    const size_t layerCount = meshes.size();
+    std::vector<size_t> nodeStarts(layerCount + 1, 0);
+    std::vector<size_t> cellStarts(layerCount + 1, 0);
+    std::vector<const double*> qualities(layerCount);
+    std::vector<int> materialIds(layerCount);
+    std::vector<int> regionIds(layerCount);
+    for (size_t l = 0; l < layerCount; l++) {
+        nodeStarts[l + 1] = nodeStarts[l] + meshes[l]->getNodeCount();
+        cellStarts[l + 1] = cellStarts[l] + meshes[l]->getElementCount();
+        // Cached after the first call, so the fill below only reads it
+        qualities[l] = meshes[l]->getElementQualityArrays().quality.data();
+        materialIds[l] = materialTypeToID(layers[l]->getMaterial().type);
+        regionIds[l] = deviceRegionToID(layers[l]->getRegion());
+    }
+    const size_t totalNodes = nodeStarts[layerCount];
+    const size_t totalCells = cellStarts[layerCount];
+    
+    grid.points.assign(totalNodes * 3, 0.0);
+    grid.connectivity.assign(totalCells * 3, 0);
+    grid.cellData.clear();
+    grid.cellData.reserve(5);
+    std::int32_t* materialOut = grid.addIntArray("MaterialID").ints.data();
+    std::int32_t* regionOut = grid.addIntArray("RegionID").ints.data();
+    std::int32_t* layerOut = grid.addIntArray("LayerIndex").ints.data();
+    float* qualityOut = grid.addFloatArray("ElementQuality").floats.data();
+    float* areaOut = grid.addFloatArray("ElementArea").floats.data();
+    
+    // Chunks cover the merged index range and may straddle layer boundaries,
+    // so small and large layers are balanced across threads alike
+    auto layerAt = [](const std::vector<size_t>& starts, size_t index) {
+        return static_cast<size_t>(std::upper_bound(starts.begin(), starts.end(), index) - starts.begin()) - 1;
+    };
+    
+    double* points = grid.points.data();
+    parallelForChunks(totalNodes, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t l = layerAt(nodeStarts, begin); begin < end; l++) {
+            const MeshNodeArrays& nodes = meshes[l]->getNodeArrays();
+            const size_t stop = std::min(end, nodeStarts[l + 1]);
+            for (size_t i = begin; i < stop; i++) {
+                const size_t local = i - nodeStarts[l];
+                points[3 * i] = nodes.x[local];
+                points[3 * i + 1] = nodes.y[local];
+                points[3 * i + 2] = nodes.z[local];
+            }
+            begin = stop;
+        }
+    });
+    
+    std::int32_t* cells = grid.connectivity.data();
+    parallelForChunks(totalCells, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t l = layerAt(cellStarts, begin); begin < end; l++) {
+            const MeshElementArrays& elements = meshes[l]->getElementArrays();
+            const std::int32_t nodeOffset = static_cast<std::int32_t>(nodeStarts[l]);
+            const size_t stop = std::min(end, cellStarts[l + 1]);
+            for (size_t c = begin; c < stop; c++) {
+                const size_t local = c - cellStarts[l];
+                const std::int32_t* tri = elements.nodes(local);
+                cells[3 * c] = tri[0] + nodeOffset;
+                cells[3 * c + 1] = tri[1] + nodeOffset;
+                cells[3 * c + 2] = tri[2] + nodeOffset;
+                materialOut[c] = materialIds[l];
+                regionOut[c] = regionIds[l];
+                layerOut[c] = static_cast<std::int32_t>(l);
+                qualityOut[c] = static_cast<float>(qualities[l][local]);
+                areaOut[c] = static_cast<float>(elements.areas[local]);
+            }
+            begin = stop;
+        }
+    });
+}
+
+size_t VTKExporter::weldGrid(VTKTriangleGrid& grid, double tolerance) {
+    const size_t pointCount = grid.pointCount();
+    const size_t cellCount = grid.cellCount();
+    
+    // SpatialHashGrid works on separate coordinate arrays
+    std::vector<double> x(pointCount), y(pointCount), z(pointCount);
+    parallelForChunks(pointCount, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            x[i] = grid.points[3 * i];
+            y[i] = grid.points[3 * i + 1];
+            z[i] = grid.points[3 * i + 2];
+        }
+    });
+    SpatialHashGrid::WeldResult weld = SpatialHashGrid::weldPoints(x.data(), y.data(), z.data(), pointCount, tolerance);
+    
+    const size_t weldedCount = weld.representatives.size();
+    std::vector<double> points(3 * weldedCount);
+    parallelForChunks(weldedCount, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++) {
+            const size_t src = static_cast<size_t>(weld.representatives[k]);
+            points[3 * k] = x[src];
+            points[3 * k + 1] = y[src];
+            points[3 * k + 2] = z[src];
+        }
+    });
+    grid.points.swap(points);
+    
+    // Renumber cells and flag the ones whose corners merged
+    std::vector<char> keep(cellCount);
+    parallelForChunks(cellCount, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            std::int32_t* tri = &grid.connectivity[3 * c];
+            tri[0] = weld.remap[tri[0]];
+            tri[1] = weld.remap[tri[1]];
+            tri[2] = weld.remap[tri[2]];
+            keep[c] = (tri[0] != tri[1] && tri[1] != tri[2] && tri[2] != tri[0]) ? 1 : 0;
+        }
+    });
+    
+    // Compact in order so layers stay contiguous
+    size_t kept = 0;
+    for (size_t c = 0; c < cellCount; c++) {
+        if (!keep[c]) continue;
+        if (kept != c) {
+            std::copy_n(grid.connectivity.begin() + 3 * c, 3, grid.connectivity.begin() + 3 * kept);
+            for (VTKCellArray& array : grid.cellData) {
+                if (array.isFloat) array.floats[kept] = array.floats[c];
+                else array.ints[kept] = array.ints[c];
+            }
+        }
+        kept++;
     }
-    file << std::endl;
-    
-    // Element area data
-    file << "SCALARS ElementArea float 1" << std::endl;
-    file << "LOOKUP_TABLE default" << std::endl;
-    for (const auto& element : elements) {
-        file << element->area << std::endl;
+    grid.connectivity.resize(3 * kept);
+    for (VTKCellArray& array : grid.cellData) {
+        if (array.isFloat) array.floats.resize(kept);
+        else array.ints.resize(kept);
     }
+    return cellCount - kept;
 }
 
 double VTKExporter::calculateTriangleQuality(const std::array<double, 3>& p1,
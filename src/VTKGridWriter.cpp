@@ -0,0 +1,429 @@
+// VTKGridWriter.cpp
+#include "VTKGridWriter.h"
+#include "OutputSink.h"
+#include "ParallelUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+#ifdef SEMICONDUCTOR_DEVICE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+const std::int32_t kVtkTriangle = 5;
+const size_t kSwapSlab = size_t(1) << 20;              // Values byte-swapped per write
+const size_t kCompressionBlock = size_t(1) << 16;      // Uncompressed bytes per zlib block
+
+bool hostIsBigEndian() {
+    const std::uint16_t one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first == 0;
+}
+
+// Legacy binary VTK is big-endian regardless of the host
+template <typename T>
+void writeBigEndian(OutputSink& out, const T* values, size_t count) {
+    if (hostIsBigEndian()) {
+        out.write(values, count * sizeof(T));
+        return;
+    }
+    std::vector<unsigned char> slab(std::min(count, kSwapSlab) * sizeof(T));
+    for (size_t first = 0; first < count; first += kSwapSlab) {
+        const size_t n = std::min(kSwapSlab, count - first);
+        parallelForChunks(n, 65536, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const unsigned char* src = reinterpret_cast<const unsigned char*>(values + first + i);
+                std::reverse_copy(src, src + sizeof(T), slab.data() + i * sizeof(T));
+            }
+        });
+        out.write(slab.data(), n * sizeof(T));
+    }
+}
+
+void writeLegacy(const VTKTriangleGrid& grid, OutputSink& out, const std::string& title, bool binary) {
+    const size_t pointCount = grid.pointCount();
+    const size_t cellCount = grid.cellCount();
+
+    out << "# vtk DataFile Version 3.0\n" << title << '\n' << (binary ? "BINARY\n" : "ASCII\n")
+        << "DATASET UNSTRUCTURED_GRID\n";
+
+    out << "POINTS " << pointCount << " double\n";
+    if (binary) {
+        writeBigEndian(out, grid.points.data(), grid.points.size());
+        out << '\n';
+    } else {
+        for (size_t i = 0; i < pointCount; i++) {
+            out << grid.points[3 * i] << ' ' << grid.points[3 * i + 1] << ' ' << grid.points[3 * i + 2] << '\n';
+        }
+    }
+
+    out << "CELLS " << cellCount << ' ' << (cellCount * 4) << '\n';
+    if (binary) {
+        std::vector<std::int32_t> cells(4 * cellCount);
+        parallelForChunks(cellCount, 65536, [&](size_t begin, size_t end) {
+            for (size_t e = begin; e < end; e++) {
+                cells[4 * e] = 3;
+                cells[4 * e + 1] = grid.connectivity[3 * e];
+                cells[4 * e + 2] = grid.connectivity[3 * e + 1];
+                cells[4 * e + 3] = grid.connectivity[3 * e + 2];
+            }
+        });
+        writeBigEndian(out, cells.data(), cells.size());
+        out << '\n';
+    } else {
+        for (size_t e = 0; e < cellCount; e++) {
+            out << "3 " << grid.connectivity[3 * e] << ' ' << grid.connectivity[3 * e + 1] << ' '
+                << grid.connectivity[3 * e + 2] << '\n';
+        }
+    }
+
+    out << "CELL_TYPES " << cellCount << '\n';
+    if (binary) {
+        const std::vector<std::int32_t> types(cellCount, kVtkTriangle);
+        writeBigEndian(out, types.data(), types.size());
+        out << '\n';
+    } else {
+        for (size_t e = 0; e < cellCount; e++) {
+            out << "5\n";
+        }
+    }
+
+    if (grid.cellData.empty()) return;
+    out << "CELL_DATA " << cellCount << '\n';
+    for (const VTKCellArray& array : grid.cellData) {
+        out << "SCALARS " << array.name << (array.isFloat ? " float 1\n" : " int 1\n") << "LOOKUP_TABLE default\n";
+        if (binary) {
+            if (array.isFloat) writeBigEndian(out, array.floats.data(), array.floats.size());
+            else writeBigEndian(out, array.ints.data(), array.ints.size());
+        } else if (array.isFloat) {
+            for (float value : array.floats) out << value << '\n';
+        } else {
+            for (std::int32_t value : array.ints) out << value << '\n';
+        }
+        out << '\n';
+    }
+}
+
+// One array of the appended-data section: either raw bytes written straight
+// from the source, or an encoded (compressed) copy
+struct AppendedArray {
+    std::string type;
+    std::string name;
+    int components;
+    const void* data;
+    size_t bytes;
+    std::vector<unsigned char> encoded;
+    bool useEncoded = false;
+
+    // Size in the appended section, including the header
+    size_t appendedSize() const { return useEncoded ? encoded.size() : sizeof(std::uint64_t) + bytes; }
+};
+
+#ifdef SEMICONDUCTOR_DEVICE_HAVE_ZLIB
+// vtkZLibDataCompressor layout: a UInt64 header [block count, block size,
+// last partial block size, compressed size of each block] followed by the
+// compressed blocks. Blocks are compressed independently in parallel.
+void compressArray(AppendedArray& array) {
+    const unsigned char* src = static_cast<const unsigned char*>(array.data);
+    const size_t blockCount = (array.bytes + kCompressionBlock - 1) / kCompressionBlock;
+
+    std::vector<std::vector<unsigned char>> blocks(blockCount);
+    std::atomic<bool> ok(true);
+    parallelForChunks(blockCount, 1, [&](size_t first, size_t last) {
+        for (size_t b = first; b < last; b++) {
+            const size_t offset = b * kCompressionBlock;
+            const size_t length = std::min(kCompressionBlock, array.bytes - offset);
+            uLongf compressedLength = compressBound(static_cast<uLong>(length));
+            blocks[b].resize(compressedLength);
+            // Fastest level: export time matters more than the last few percent of size
+            if (compress2(blocks[b].data(), &compressedLength, src + offset,
+                          static_cast<uLong>(length), Z_BEST_SPEED) != Z_OK) {
+                ok.store(false, std::memory_order_relaxed);
+                return;
+            }
+            blocks[b].resize(compressedLength);
+        }
+    });
+    if (!ok.load()) {
+        throw std::runtime_error("zlib compression failed for array " + array.name);
+    }
+
+    std::vector<std::uint64_t> header(3 + blockCount);
+    header[0] = blockCount;
+    header[1] = kCompressionBlock;
+    header[2] = array.bytes % kCompressionBlock;
+    size_t total = header.size() * sizeof(std::uint64_t);
+    for (size_t b = 0; b < blockCount; b++) {
+        header[3 + b] = blocks[b].size();
+        total += blocks[b].size();
+    }
+
+    array.encoded.resize(total);
+    unsigned char* dst = array.encoded.data();
+    std::memcpy(dst, header.data(), header.size() * sizeof(std::uint64_t));
+    dst += header.size() * sizeof(std::uint64_t);
+    for (const auto& block : blocks) {
+        std::memcpy(dst, block.data(), block.size());
+        dst += block.size();
+    }
+    array.useEncoded = true;
+}
+#endif
+
+void writeXML(const VTKTriangleGrid& grid, OutputSink& out, bool compress) {
+    const size_t pointCount = grid.pointCount();
+    const size_t cellCount = grid.cellCount();
+
+#ifndef SEMICONDUCTOR_DEVICE_HAVE_ZLIB
+    if (compress) {
+        std::cerr << "Warning: built without zlib, writing uncompressed VTU data" << std::endl;
+        compress = false;
+    }
+#endif
+
+    // Offsets are the running end of each cell's connectivity: 3, 6, 9, ...
+    const bool wideOffsets = 3 * cellCount > static_cast<size_t>(std::numeric_limits<std::int32_t>::max());
+    std::vector<std::int32_t> offsets32;
+    std::vector<std::int64_t> offsets64;
+    if (wideOffsets) offsets64.resize(cellCount);
+    else offsets32.resize(cellCount);
+    parallelForChunks(cellCount, 65536, [&](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++) {
+            if (wideOffsets) offsets64[e] = static_cast<std::int64_t>(3 * (e + 1));
+            else offsets32[e] = static_cast<std::int32_t>(3 * (e + 1));
+        }
+    });
+    const std::vector<std::uint8_t> types(cellCount, static_cast<std::uint8_t>(kVtkTriangle));
+
+    std::vector<AppendedArray> arrays;
+    arrays.push_back({"Float64", "Points", 3, grid.points.data(), grid.points.size() * sizeof(double), {}});
+    arrays.push_back({"Int32", "connectivity", 1, grid.connectivity.data(),
+                      grid.connectivity.size() * sizeof(std::int32_t), {}});
+    if (wideOffsets) {
+        arrays.push_back({"Int64", "offsets", 1, offsets64.data(), offsets64.size() * sizeof(std::int64_t), {}});
+    } else {
+        arrays.push_back({"Int32", "offsets", 1, offsets32.data(), offsets32.size() * sizeof(std::int32_t), {}});
+    }
+    arrays.push_back({"UInt8", "types", 1, types.data(), types.size(), {}});
+    for (const VTKCellArray& array : grid.cellData) {
+        if (array.isFloat) {
+            arrays.push_back({"Float32", array.name, 1, array.floats.data(), array.floats.size() * sizeof(float), {}});
+        } else {
+            arrays.push_back({"Int32", array.name, 1, array.ints.data(), array.ints.size() * sizeof(std::int32_t), {}});
+        }
+    }
+
+#ifdef SEMICONDUCTOR_DEVICE_HAVE_ZLIB
+    if (compress) {
+        for (AppendedArray& array : arrays) {
+            compressArray(array);
+        }
+    }
+#endif
+
+    std::vector<size_t> offsets(arrays.size());
+    size_t offset = 0;
+    for (size_t a = 0; a < arrays.size(); a++) {
+        offsets[a] = offset;
+        offset += arrays[a].appendedSize();
+    }
+
+    auto dataArray = [&](size_t a, const char* indent) {
+        const AppendedArray& array = arrays[a];
+        out << indent << "<DataArray type=\"" << array.type << "\" Name=\"" << array.name << '"';
+        if (array.components > 1) out << " NumberOfComponents=\"" << array.components << '"';
+        out << " format=\"appended\" offset=\"" << offsets[a] << "\"/>\n";
+    };
+
+    out << "<?xml version=\"1.0\"?>\n"
+        << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\""
+        << (hostIsBigEndian() ? "BigEndian" : "LittleEndian") << "\" header_type=\"UInt64\"";
+    if (compress) out << " compressor=\"vtkZLibDataCompressor\"";
+    out << ">\n  <UnstructuredGrid>\n"
+        << "    <Piece NumberOfPoints=\"" << pointCount << "\" NumberOfCells=\"" << cellCount << "\">\n"
+        << "      <Points>\n";
+    dataArray(0, "        ");
+    out << "      </Points>\n      <Cells>\n";
+    for (size_t a = 1; a < 4; a++) dataArray(a, "        ");
+    out << "      </Cells>\n";
+    if (arrays.size() > 4) {
+        out << "      <CellData>\n";
+        for (size_t a = 4; a < arrays.size(); a++) dataArray(a, "        ");
+        out << "      </CellData>\n";
+    }
+    out << "    </Piece>\n  </UnstructuredGrid>\n  <AppendedData encoding=\"raw\">\n   _";
+
+    for (const AppendedArray& array : arrays) {
+        if (array.useEncoded) {
+            out.write(array.encoded.data(), array.encoded.size());
+        } else {
+            const std::uint64_t bytes = array.bytes;
+            out.write(&bytes, sizeof(bytes));
+            out.write(array.data, array.bytes);
+        }
+    }
+    out << "\n  </AppendedData>\n</VTKFile>\n";
+}
+
+// Parallel index: array layout only, the data lives in the pieces
+void writeParallelIndex(const VTKTriangleGrid& grid, OutputSink& out, bool compress,
+                        const std::vector<std::string>& sources) {
+    out << "<?xml version=\"1.0\"?>\n"
+        << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\""
+        << (hostIsBigEndian() ? "BigEndian" : "LittleEndian") << "\" header_type=\"UInt64\"";
+    if (compress) out << " compressor=\"vtkZLibDataCompressor\"";
+    out << ">\n  <PUnstructuredGrid GhostLevel=\"0\">\n"
+        << "    <PPoints>\n"
+        << "      <PDataArray type=\"Float64\" Name=\"Points\" NumberOfComponents=\"3\"/>\n"
+        << "    </PPoints>\n";
+    if (!grid.cellData.empty()) {
+        out << "    <PCellData>\n";
+        for (const VTKCellArray& array : grid.cellData) {
+            out << "      <PDataArray type=\"" << (array.isFloat ? "Float32" : "Int32")
+                << "\" Name=\"" << array.name << "\"/>\n";
+        }
+        out << "    </PCellData>\n";
+    }
+    for (const std::string& source : sources) {
+        out << "    <Piece Source=\"" << source << "\"/>\n";
+    }
+    out << "  </PUnstructuredGrid>\n</VTKFile>\n";
+}
+
+} // namespace
+
+void VTKGridWriter::write(const VTKTriangleGrid& grid, const std::string& filename,
+                          const std::string& title, const VTKWriteOptions& options) {
+    OutputSink out(filename);
+    write(grid, out, title, options);
+    out.close();
+}
+
+void VTKGridWriter::write(const VTKTriangleGrid& grid, OutputSink& out,
+                          const std::string& title, const VTKWriteOptions& options) {
+    for (const VTKCellArray& array : grid.cellData) {
+        if (array.size() != grid.cellCount()) {
+            throw std::runtime_error("Cell array " + array.name + " does not match the cell count");
+        }
+    }
+
+    switch (options.format) {
+        case VTKFormat::LegacyASCII: writeLegacy(grid, out, title, false); break;
+        case VTKFormat::LegacyBinary: writeLegacy(grid, out, title, true); break;
+        case VTKFormat::XMLBinary: writeXML(grid, out, options.compress); break;
+    }
+    out.flush();
+}
+
+VTKTriangleGrid VTKGridWriter::extractCells(const VTKTriangleGrid& grid, const std::vector<size_t>& cells) {
+    VTKTriangleGrid piece;
+    piece.connectivity.resize(3 * cells.size());
+    for (size_t i = 0; i < cells.size(); i++) {
+        std::copy_n(grid.connectivity.begin() + 3 * cells[i], 3, piece.connectivity.begin() + 3 * i);
+    }
+
+    // Used points in ascending order; sorting keeps a layer's nodes together
+    std::vector<std::int32_t> used(piece.connectivity);
+    std::sort(used.begin(), used.end());
+    used.erase(std::unique(used.begin(), used.end()), used.end());
+
+    piece.points.resize(3 * used.size());
+    for (size_t i = 0; i < used.size(); i++) {
+        std::copy_n(grid.points.begin() + 3 * static_cast<size_t>(used[i]), 3, piece.points.begin() + 3 * i);
+    }
+    for (std::int32_t& node : piece.connectivity) {
+        node = static_cast<std::int32_t>(std::lower_bound(used.begin(), used.end(), node) - used.begin());
+    }
+
+    piece.cellData.reserve(grid.cellData.size());
+    for (const VTKCellArray& array : grid.cellData) {
+        VTKCellArray& out = array.isFloat ? piece.addFloatArray(array.name) : piece.addIntArray(array.name);
+        for (size_t i = 0; i < cells.size(); i++) {
+            if (array.isFloat) out.floats[i] = array.floats[cells[i]];
+            else out.ints[i] = array.ints[cells[i]];
+        }
+    }
+    return piece;
+}
+
+size_t VTKGridWriter::writePartitioned(const VTKTriangleGrid& grid,
+                                       const std::vector<std::int32_t>& cellPiece,
+                                       size_t pieceCount, const std::string& filename,
+                                       bool compress) {
+    if (cellPiece.size() != grid.cellCount()) {
+        throw std::runtime_error("Piece assignment does not match the cell count");
+    }
+
+    // Bucket cells by piece, keeping their original order within a piece
+    std::vector<std::vector<size_t>> pieceCells(pieceCount);
+    for (size_t c = 0; c < cellPiece.size(); c++) {
+        const std::int32_t piece = cellPiece[c];
+        if (piece < 0 || static_cast<size_t>(piece) >= pieceCount) {
+            throw std::runtime_error("Cell assigned to a piece outside [0, pieceCount)");
+        }
+        pieceCells[piece].push_back(c);
+    }
+
+    // Pieces go next to the index and are referenced relative to it
+    const size_t slash = filename.find_last_of("/\\");
+    const std::string directory = (slash == std::string::npos) ? std::string() : filename.substr(0, slash + 1);
+    std::string stem = filename.substr(directory.size());
+    const size_t dot = stem.rfind('.');
+    if (dot != std::string::npos && dot > 0) stem.erase(dot);
+
+    std::vector<size_t> written;
+    std::vector<std::string> sources;
+    for (size_t k = 0; k < pieceCount; k++) {
+        if (pieceCells[k].empty()) continue;
+        written.push_back(k);
+        sources.push_back(stem + "_" + std::to_string(k) + ".vtu");
+    }
+
+    VTKWriteOptions pieceOptions;
+    pieceOptions.format = VTKFormat::XMLBinary;
+    pieceOptions.compress = compress;
+
+    // One task per piece: each extracts and writes its own file, so both the
+    // gathering and the I/O run concurrently. Failures are collected and the
+    // first one is rethrown once every piece has finished.
+    std::mutex errorMutex;
+    std::string firstError;
+    parallelForChunks(written.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            try {
+                const VTKTriangleGrid piece = extractCells(grid, pieceCells[written[i]]);
+                write(piece, directory + sources[i], std::string(), pieceOptions);
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (firstError.empty()) firstError = e.what();
+            }
+        }
+    });
+    if (!firstError.empty()) {
+        throw std::runtime_error(firstError);
+    }
+
+#ifndef SEMICONDUCTOR_DEVICE_HAVE_ZLIB
+    compress = false;
+#endif
+    OutputSink out(filename);
+    writeParallelIndex(grid, out, compress, sources);
+    out.close();
+    return sources.size();
+}
+
+bool VTKGridWriter::hasCompression() {
+#ifdef SEMICONDUCTOR_DEVICE_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}